@@ -36,7 +36,8 @@ static inline void do_cpuid(unsigned int *eax, unsigned int *ebx,
 		  "=S" (*ebx),
 		  "=c" (*ecx),
 		  "=d" (*edx)
-		: "a"  (*eax)
+		: "a"  (*eax),
+		  "c"  (*ecx)
 		: "rbx"
 		);
 #else
@@ -47,7 +48,8 @@ static inline void do_cpuid(unsigned int *eax, unsigned int *ebx,
 		  "=S" (*ebx),
 		  "=c" (*ecx),
 		  "=d" (*edx)
-		: "a"  (*eax)
+		: "a"  (*eax),
+		  "c"  (*ecx)
 		: "ebx"
 		);
 #endif
@@ -68,6 +70,20 @@ static void __cpuid(int info[4], int x)
 #endif
 }
 
+static void __cpuidex(int info[4], int x, int subleaf)
+{
+#if defined __FreeBSD__
+	cpuid_count((u_int)x, (u_int)subleaf, (u_int*)info);
+#else
+	unsigned int eax = x, ebx = 0, ecx = subleaf, edx = 0;
+	do_cpuid(&eax, &ebx, &ecx, &edx);
+	info[0] = eax;
+	info[1] = ebx;
+	info[2] = ecx;
+	info[3] = edx;
+#endif
+}
+
 #define _XCR_XFEATURE_ENABLED_MASK 0
 static unsigned long long _xgetbv(unsigned int index)
 {
@@ -165,6 +181,14 @@ void CPUInfo::Detect()
 		}
 	}
 
+	if (max_std_fn >= 7)
+	{
+		__cpuidex(cpu_id, 0x00000007, 0x00000000);
+		// AVX2 relies on the same OS support as AVX.
+		if (bAVX && ((cpu_id[1] >> 5) & 1))
+			bAVX2 = true;
+	}
+
 	bFlushToZero = bSSE;
 
 	if (max_ex_fn >= 0x80000004) {
@@ -225,6 +249,7 @@ std::string CPUInfo::Summarize()
 	if (bSSE4_2) sum += ", SSE4.2";
 	if (HTT) sum += ", HTT";
 	if (bAVX) sum += ", AVX";
+	if (bAVX2) sum += ", AVX2";
 	if (bFMA) sum += ", FMA";
 	if (bAES) sum += ", AES";
 	if (bMOVBE) sum += ", MOVBE";
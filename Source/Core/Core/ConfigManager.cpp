@@ -495,6 +495,8 @@ void SConfig::LoadCoreSettings(IniFile& ini)
 	core->Get("CPUCore",      &m_LocalCoreStartupParameter.iCPUCore, 0);
 #endif
 	core->Get("Fastmem",           &m_LocalCoreStartupParameter.bFastmem,      true);
+	core->Get("JITAnalysisCache",  &m_LocalCoreStartupParameter.bJITAnalysisCache, false);
+	core->Get("JITInlineFunctions", &m_LocalCoreStartupParameter.bJITInlineFunctions, false);
 	core->Get("DSPThread",         &m_LocalCoreStartupParameter.bDSPThread,    false);
 	core->Get("DSPHLE",            &m_LocalCoreStartupParameter.bDSPHLE,       true);
 	core->Get("CPUThread",         &m_LocalCoreStartupParameter.bCPUThread,    true);
@@ -529,6 +531,8 @@ void SConfig::LoadCoreSettings(IniFile& ini)
 	core->Get("BBDumpPort",                &m_LocalCoreStartupParameter.iBBDumpPort,       -1);
 	core->Get("VBeam",                     &m_LocalCoreStartupParameter.bVBeamSpeedHack,   false);
 	core->Get("SyncGPU",                   &m_LocalCoreStartupParameter.bSyncGPU,          false);
+	core->Get("DeterministicGPUThread",    &m_LocalCoreStartupParameter.bDeterministicGPUThread, false);
+	core->Get("BulkFifoReads",             &m_LocalCoreStartupParameter.bBulkFifoReads,    false);
 	core->Get("FastDiscSpeed",             &m_LocalCoreStartupParameter.bFastDiscSpeed,    false);
 	core->Get("DCBZ",                      &m_LocalCoreStartupParameter.bDCBZOFF,          false);
 	core->Get("FrameLimit",                &m_Framelimit,                                  1); // auto frame limit by default
@@ -22,7 +22,8 @@
 
 SCoreStartupParameter::SCoreStartupParameter()
 : bEnableDebugging(false), bAutomaticStart(false), bBootToPause(false),
-  bJITNoBlockCache(false), bJITBlockLinking(true),
+  bJITNoBlockCache(false), bJITBlockLinking(true), bJITAnalysisCache(false),
+  bJITInlineFunctions(false),
   bJITOff(false),
   bJITLoadStoreOff(false), bJITLoadStorelXzOff(false),
   bJITLoadStorelwzOff(false), bJITLoadStorelbzxOff(false),
@@ -39,8 +40,8 @@ SCoreStartupParameter::SCoreStartupParameter()
   bDPL2Decoder(false), iLatency(14),
   bRunCompareServer(false), bRunCompareClient(false),
   bMMU(false), bDCBZOFF(false), bTLBHack(false), iBBDumpPort(0), bVBeamSpeedHack(false),
-  bSyncGPU(false), bFastDiscSpeed(false),
-  SelectedLanguage(0), bWii(false),
+  bSyncGPU(false), bDeterministicGPUThread(false), bBulkFifoReads(false),
+  bFastDiscSpeed(false), SelectedLanguage(0), bWii(false),
   bConfirmStop(false), bHideCursor(false),
   bAutoHideCursor(false), bUsePanicHandlers(true), bOnScreenDisplayMessages(true),
   iRenderWindowXPos(-1), iRenderWindowYPos(-1),
@@ -78,6 +79,8 @@ void SCoreStartupParameter::LoadDefaults()
 	iBBDumpPort = -1;
 	bVBeamSpeedHack = false;
 	bSyncGPU = false;
+	bDeterministicGPUThread = false;
+	bBulkFifoReads = false;
 	bFastDiscSpeed = false;
 	bMergeBlocks = false;
 	bEnableMemcardSaving = true;
@@ -101,6 +101,8 @@ struct SCoreStartupParameter
 
 	// JIT (shared between JIT and JITIL)
 	bool bJITNoBlockCache, bJITBlockLinking;
+	bool bJITAnalysisCache;
+	bool bJITInlineFunctions;
 	bool bJITOff;
 	bool bJITLoadStoreOff, bJITLoadStorelXzOff, bJITLoadStorelwzOff, bJITLoadStorelbzxOff;
 	bool bJITLoadStoreFloatingOff;
@@ -139,6 +141,8 @@ struct SCoreStartupParameter
 	int iBBDumpPort;
 	bool bVBeamSpeedHack;
 	bool bSyncGPU;
+	bool bDeterministicGPUThread;
+	bool bBulkFifoReads;
 	bool bFastDiscSpeed;
 
 	int SelectedLanguage;
@@ -2,6 +2,7 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cinttypes>
 #include <string>
 #include <vector>
@@ -26,6 +27,10 @@ struct EventType
 {
 	TimedCallback callback;
 	std::string name;
+	// Bumped by RemoveEvent; queued events with an older generation are dead.
+	u32 generation;
+	// Number of live events of this type in the queue.
+	int pending;
 };
 
 static std::vector<EventType> event_types;
@@ -37,16 +42,28 @@ struct BaseEvent
 	int type;
 };
 
-typedef LinkedListItem<BaseEvent> Event;
+struct Event : BaseEvent
+{
+	// Keeps events scheduled for the same time in the order they were added.
+	u64 fifo_order;
+	u32 generation;
+};
+
+// Min-heap on (time, fifo_order), maintained with std::push_heap/pop_heap.
+// Removed events are left in the heap and skipped when they reach the top.
+static bool operator>(const Event& left, const Event& right)
+{
+	if (left.time != right.time)
+		return left.time > right.time;
+	return left.fifo_order > right.fifo_order;
+}
 
 // STATE_TO_SAVE
-static Event *first;
+static std::vector<Event> s_event_queue;
+static u64 s_event_fifo_id;
 static std::mutex tsWriteLock;
 static Common::FifoQueue<BaseEvent, false> tsQueue;
 
-// event pools
-static Event *eventPool = nullptr;
-
 int slicelength;
 static int maxSliceLength = MAX_SLICE_LENGTH;
 
@@ -63,20 +80,53 @@ static int ev_lost;
 
 static void (*advanceCallback)(int cyclesExecuted) = nullptr;
 
-static Event* GetNewEvent()
+static bool IsLive(const Event& ev)
 {
-	if (!eventPool)
-		return new Event;
+	return ev.generation == event_types[ev.type].generation;
+}
+
+static void AddEventToQueue(const BaseEvent& base)
+{
+	Event ne;
+	static_cast<BaseEvent&>(ne) = base;
+	ne.fifo_order = s_event_fifo_id++;
+	ne.generation = event_types[ne.type].generation;
+	event_types[ne.type].pending++;
+
+	s_event_queue.push_back(ne);
+	std::push_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
+}
 
-	Event* ev = eventPool;
-	eventPool = ev->next;
+static Event PopEvent()
+{
+	std::pop_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
+	Event ev = s_event_queue.back();
+	s_event_queue.pop_back();
 	return ev;
 }
 
-static void FreeEvent(Event* ev)
+// Drops removed events from the top of the queue, so that front() is the next
+// event that will actually fire.
+static void PruneRemovedEvents()
 {
-	ev->next = eventPool;
-	eventPool = ev;
+	while (!s_event_queue.empty() && !IsLive(s_event_queue.front()))
+		PopEvent();
+}
+
+// Returns the live events in the order they will fire.
+static std::vector<Event> GetSortedEvents()
+{
+	std::vector<Event> events;
+	events.reserve(s_event_queue.size());
+	for (const Event& ev : s_event_queue)
+	{
+		if (IsLive(ev))
+			events.push_back(ev);
+	}
+	std::sort(events.begin(), events.end(), [](const Event& left, const Event& right) {
+		return right > left;
+	});
+	return events;
 }
 
 static void EmptyTimedCallback(u64 userdata, int cyclesLate) {}
@@ -86,6 +136,8 @@ int RegisterEvent(const std::string& name, TimedCallback callback)
 	EventType type;
 	type.name = name;
 	type.callback = callback;
+	type.generation = 0;
+	type.pending = 0;
 
 	// check for existing type with same name.
 	// we want event type names to remain unique so that we can use them for serialization.
@@ -107,7 +159,8 @@ int RegisterEvent(const std::string& name, TimedCallback callback)
 
 void UnregisterAllEvents()
 {
-	if (first)
+	PruneRemovedEvents();
+	if (!s_event_queue.empty())
 		PanicAlertT("Cannot unregister events with events pending");
 	event_types.clear();
 }
@@ -128,13 +181,7 @@ void Shutdown()
 	MoveEvents();
 	ClearPendingEvents();
 	UnregisterAllEvents();
-
-	while (eventPool)
-	{
-		Event *ev = eventPool;
-		eventPool = ev->next;
-		delete ev;
-	}
+	s_event_queue.shrink_to_fit();
 }
 
 static void EventDoState(PointerWrap &p, BaseEvent* ev)
@@ -185,7 +232,34 @@ void DoState(PointerWrap &p)
 
 	MoveEvents();
 
-	p.DoLinkedList<BaseEvent, GetNewEvent, FreeEvent, EventDoState>(first);
+	// Same layout as the linked list this used to be: each event in firing
+	// order, preceded by a 1 byte, and a 0 byte at the end.
+	if (p.GetMode() == PointerWrap::MODE_READ)
+	{
+		ClearPendingEvents();
+		while (true)
+		{
+			u8 should_exist = 0;
+			p.Do(should_exist);
+			if (!should_exist)
+				break;
+
+			BaseEvent ev;
+			EventDoState(p, &ev);
+			AddEventToQueue(ev);
+		}
+	}
+	else
+	{
+		for (Event& ev : GetSortedEvents())
+		{
+			u8 should_exist = 1;
+			p.Do(should_exist);
+			EventDoState(p, &ev);
+		}
+		u8 should_exist = 0;
+		p.Do(should_exist);
+	}
 	p.DoMarker("CoreTimingEvents");
 }
 
@@ -204,7 +278,7 @@ u64 GetIdleTicks()
 void ScheduleEvent_Threadsafe(int cyclesIntoFuture, int event_type, u64 userdata)
 {
 	std::lock_guard<std::mutex> lk(tsWriteLock);
-	Event ne;
+	BaseEvent ne;
 	ne.time = globalTimer + cyclesIntoFuture;
 	ne.type = event_type;
 	ne.userdata = userdata;
@@ -227,30 +301,9 @@ void ScheduleEvent_Threadsafe_Immediate(int event_type, u64 userdata)
 
 void ClearPendingEvents()
 {
-	while (first)
-	{
-		Event *e = first->next;
-		FreeEvent(first);
-		first = e;
-	}
-}
-
-static void AddEventToQueue(Event* ne)
-{
-	Event* prev = nullptr;
-	Event** pNext = &first;
-	for (;;)
-	{
-		Event*& next = *pNext;
-		if (!next || ne->time < next->time)
-		{
-			ne->next = next;
-			next = ne;
-			break;
-		}
-		prev = next;
-		pNext = &prev->next;
-	}
+	s_event_queue.clear();
+	for (auto& event_type : event_types)
+		event_type.pending = 0;
 }
 
 // This must be run ONLY from within the cpu thread
@@ -258,10 +311,10 @@ static void AddEventToQueue(Event* ne)
 // than Advance
 void ScheduleEvent(int cyclesIntoFuture, int event_type, u64 userdata)
 {
-	Event *ne = GetNewEvent();
-	ne->userdata = userdata;
-	ne->type = event_type;
-	ne->time = globalTimer + cyclesIntoFuture;
+	BaseEvent ne;
+	ne.userdata = userdata;
+	ne.type = event_type;
+	ne.time = globalTimer + cyclesIntoFuture;
 	AddEventToQueue(ne);
 }
 
@@ -272,55 +325,18 @@ void RegisterAdvanceCallback(void (*callback)(int cyclesExecuted))
 
 bool IsScheduled(int event_type)
 {
-	if (!first)
-		return false;
-	Event *e = first;
-	while (e) {
-		if (e->type == event_type)
-			return true;
-		e = e->next;
-	}
-	return false;
+	return event_types[event_type].pending != 0;
 }
 
 void RemoveEvent(int event_type)
 {
-	if (!first)
-		return;
-
-	while (first)
-	{
-		if (first->type == event_type)
-		{
-			Event *next = first->next;
-			FreeEvent(first);
-			first = next;
-		}
-		else
-		{
-			break;
-		}
-	}
-
-	if (!first)
+	EventType& type = event_types[event_type];
+	if (!type.pending)
 		return;
 
-	Event *prev = first;
-	Event *ptr = prev->next;
-	while (ptr)
-	{
-		if (ptr->type == event_type)
-		{
-			prev->next = ptr->next;
-			FreeEvent(ptr);
-			ptr = prev->next;
-		}
-		else
-		{
-			prev = ptr;
-			ptr = ptr->next;
-		}
-	}
+	// The events stay in the queue until they come up; see PruneRemovedEvents.
+	type.generation++;
+	type.pending = 0;
 }
 
 void RemoveAllEvents(int event_type)
@@ -349,41 +365,32 @@ void ResetSliceLength()
 }
 
 
+// Runs every event that is due, including ones the callbacks schedule for now.
+static void RunDueEvents()
+{
+	while (!s_event_queue.empty() && s_event_queue.front().time <= globalTimer)
+	{
+		Event evt = PopEvent();
+		if (!IsLive(evt))
+			continue;
+
+		event_types[evt.type].pending--;
+		event_types[evt.type].callback(evt.userdata, (int)(globalTimer - evt.time));
+	}
+}
+
 //This raise only the events required while the fifo is processing data
 void ProcessFifoWaitEvents()
 {
 	MoveEvents();
-
-	if (!first)
-		return;
-
-	while (first)
-	{
-		if (first->time <= globalTimer)
-		{
-			Event* evt = first;
-			first = first->next;
-			event_types[evt->type].callback(evt->userdata, (int)(globalTimer - evt->time));
-			FreeEvent(evt);
-		}
-		else
-		{
-			break;
-		}
-	}
+	RunDueEvents();
 }
 
 void MoveEvents()
 {
 	BaseEvent sevt;
 	while (tsQueue.Pop(sevt))
-	{
-		Event *evt = GetNewEvent();
-		evt->time = sevt.time;
-		evt->userdata = sevt.userdata;
-		evt->type = sevt.type;
-		AddEventToQueue(evt);
-	}
+		AddEventToQueue(sevt);
 }
 
 void Advance()
@@ -394,31 +401,17 @@ void Advance()
 	globalTimer += cyclesExecuted;
 	PowerPC::ppcState.downcount = slicelength;
 
-	while (first)
-	{
-		if (first->time <= globalTimer)
-		{
-			//LOG(POWERPC, "[Scheduler] %s     (%lld, %lld) ",
-			//             event_types[first->type].name ? event_types[first->type].name : "?", (u64)globalTimer, (u64)first->time);
-			Event* evt = first;
-			first = first->next;
-			event_types[evt->type].callback(evt->userdata, (int)(globalTimer - evt->time));
-			FreeEvent(evt);
-		}
-		else
-		{
-			break;
-		}
-	}
+	RunDueEvents();
+	PruneRemovedEvents();
 
-	if (!first)
+	if (s_event_queue.empty())
 	{
 		WARN_LOG(POWERPC, "WARNING - no events in queue. Setting downcount to 10000");
 		PowerPC::ppcState.downcount += 10000;
 	}
 	else
 	{
-		slicelength = (int)(first->time - globalTimer);
+		slicelength = (int)(s_event_queue.front().time - globalTimer);
 		if (slicelength > maxSliceLength)
 			slicelength = maxSliceLength;
 		PowerPC::ppcState.downcount = slicelength;
@@ -430,12 +423,8 @@ void Advance()
 
 void LogPendingEvents()
 {
-	Event *ptr = first;
-	while (ptr)
-	{
-		INFO_LOG(POWERPC, "PENDING: Now: %" PRId64 " Pending: %" PRId64 " Type: %d", globalTimer, ptr->time, ptr->type);
-		ptr = ptr->next;
-	}
+	for (const Event& ev : GetSortedEvents())
+		INFO_LOG(POWERPC, "PENDING: Now: %" PRId64 " Pending: %" PRId64 " Type: %d", globalTimer, ev.time, ev.type);
 }
 
 void Idle()
@@ -459,19 +448,17 @@ void Idle()
 
 std::string GetScheduledEventsSummary()
 {
-	Event *ptr = first;
 	std::string text = "Scheduled events\n";
 	text.reserve(1000);
-	while (ptr)
+	for (const Event& ev : GetSortedEvents())
 	{
-		unsigned int t = ptr->type;
+		unsigned int t = ev.type;
 		if (t >= event_types.size())
 			PanicAlertT("Invalid event type %i", t);
 
-		const std::string& name = event_types[ptr->type].name;
+		const std::string& name = event_types[ev.type].name;
 
-		text += StringFromFormat("%s : %" PRIi64 " %016" PRIx64 "\n", name.c_str(), ptr->time, ptr->userdata);
-		ptr = ptr->next;
+		text += StringFromFormat("%s : %" PRIi64 " %016" PRIx64 "\n", name.c_str(), ev.time, ev.userdata);
 	}
 	return text;
 }
@@ -65,6 +65,54 @@ static void Reset()
 	memset(code_flags, 0, sizeof(code_flags));
 }
 
+static bool IsMailboxHigh(u16 addr)
+{
+	return addr == (0xff00 | DSP_DMBH) || addr == (0xff00 | DSP_CMBH);
+}
+
+// Besides the signatures above, a loop that only reads the high half of a
+// mailbox into an accumulator, tests it, and jumps back is waiting on the CPU.
+// start_addr is the jump target, branch_addr the conditional jump.
+static bool IsMailboxWaitLoop(u16 start_addr, u16 branch_addr)
+{
+	bool reads_mailbox = false;
+	for (u16 addr = start_addr; addr < branch_addr;)
+	{
+		UDSPInstruction inst = dsp_imem_read(addr);
+		const DSPOPCTemplate *opcode = GetOpTemplate(inst);
+		if (!opcode)
+			return false;
+
+		switch (opcode->opcode)
+		{
+		case 0x2000: // LRS $(0x18+D), @M
+			if (!IsMailboxHigh(0xff00 | (inst & 0xff)))
+				return false;
+			reads_mailbox = true;
+			break;
+		case 0x00c0: // LR $D, @M
+			if ((inst & 0x1f) < DSP_REG_AXL0 || !IsMailboxHigh(dsp_imem_read(addr + 1)))
+				return false;
+			reads_mailbox = true;
+			break;
+		case 0x0280: // CMPI
+		case 0x02a0: // ANDF
+		case 0x02c0: // ANDCF
+			break;
+		case 0x8600: // TSTAXH
+		case 0xb100: // TST
+			// Only without an extended opcode, which could access memory.
+			if (inst & 0xff)
+				return false;
+			break;
+		default:
+			return false;
+		}
+		addr += opcode->size;
+	}
+	return reads_mailbox;
+}
+
 static void AnalyzeRange(int start_addr, int end_addr)
 {
 	// First we run an extremely simplified version of a disassembler to find
@@ -122,6 +170,17 @@ static void AnalyzeRange(int start_addr, int end_addr)
 			)
 		code_flags[addr + opcode->size] |= CODE_CHECK_INT;
 
+		// Look for mailbox wait loops: a conditional JMP back to a mailbox read.
+		if ((inst & 0xfff0) == 0x0290 && (inst & 0xf) != 0xf)
+		{
+			u16 dest = dsp_imem_read(addr + 1);
+			if (dest <= addr && IsMailboxWaitLoop(dest, addr))
+			{
+				INFO_LOG(DSPLLE, "Mailbox wait loop found at %02x", dest);
+				code_flags[dest] |= CODE_IDLE_SKIP;
+			}
+		}
+
 		addr += opcode->size;
 	}
 
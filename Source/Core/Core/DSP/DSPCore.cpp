@@ -23,6 +23,8 @@
 
    ====================================================================*/
 
+#include <algorithm>
+
 #include "Common/Common.h"
 #include "Common/Event.h"
 #include "Common/FileUtil.h"
@@ -271,21 +273,40 @@ int DSPCore_RunCycles(int cycles)
 {
 	if (dspjit)
 	{
-		if (g_dsp.external_interrupt_waiting)
+		// cyclesLeft is only 16 bits wide, so long slices are run in parts. The
+		// last block of a part may overrun it, which leaves cyclesLeft negative.
+		while (cycles > 0)
 		{
-			DSPCore_CheckExternalInterrupt();
-			DSPCore_CheckExceptions();
-			DSPCore_SetExternalInterrupt(false);
+			const int part = std::min(cycles, 0x4000);
+			cyclesLeft = part;
+			do
+			{
+				if (g_dsp.external_interrupt_waiting)
+				{
+					DSPCore_CheckExternalInterrupt();
+					DSPCore_CheckExceptions();
+					DSPCore_SetExternalInterrupt(false);
+				}
+
+				DSPCompiledCode pExecAddr = (DSPCompiledCode)dspjit->enterDispatcher;
+				pExecAddr();
+
+				if (g_dsp.reset_dspjit_codespace)
+					dspjit->ClearIRAMandDSPJITCodespaceReset();
+
+				// On the DSP thread, the dispatcher also returns early when the CPU
+				// raises an interrupt. Handle it and run the rest of the part instead
+				// of dropping it.
+			} while (g_dsp.external_interrupt_waiting && !(g_dsp.cr & CR_HALT) &&
+			         (s16)cyclesLeft > 0);
+
+			cycles -= part - (s16)cyclesLeft;
+			// The DSP halted or gave up the rest of the part.
+			if ((s16)cyclesLeft > 0)
+				break;
 		}
 
-		cyclesLeft = cycles;
-		DSPCompiledCode pExecAddr = (DSPCompiledCode)dspjit->enterDispatcher;
-		pExecAddr();
-
-		if (g_dsp.reset_dspjit_codespace)
-			dspjit->ClearIRAMandDSPJITCodespaceReset();
-
-		return cyclesLeft;
+		return std::max(cycles, 0);
 	}
 
 	while (cycles > 0)
@@ -12,7 +12,6 @@
 #include "Core/DSP/DSPMemoryMap.h"
 
 #define MAX_BLOCK_SIZE 250
-#define DSP_IDLE_SKIP_CYCLES 0x1000
 
 using namespace Gen;
 
@@ -264,14 +263,7 @@ void DSPEmitter::Compile(u16 start_addr)
 			DSPJitRegCache c(gpr);
 			HandleLoop();
 			gpr.saveRegs();
-			if (!DSPHost::OnThread() && DSPAnalyzer::code_flags[start_addr] & DSPAnalyzer::CODE_IDLE_SKIP)
-			{
-				MOV(16, R(EAX), Imm16(DSP_IDLE_SKIP_CYCLES));
-			}
-			else
-			{
-				MOV(16, R(EAX), Imm16(blockSize[start_addr]));
-			}
+			MOV(16, R(EAX), Imm16(blockSize[start_addr]));
 			JMP(returnDispatcher, true);
 			gpr.loadRegs(false);
 			gpr.flushRegs(c,false);
@@ -298,14 +290,7 @@ void DSPEmitter::Compile(u16 start_addr)
 				DSPJitRegCache c(gpr);
 				//don't update g_dsp.pc -- the branch insn already did
 				gpr.saveRegs();
-				if (!DSPHost::OnThread() && DSPAnalyzer::code_flags[start_addr] & DSPAnalyzer::CODE_IDLE_SKIP)
-				{
-					MOV(16, R(EAX), Imm16(DSP_IDLE_SKIP_CYCLES));
-				}
-				else
-				{
-					MOV(16, R(EAX), Imm16(blockSize[start_addr]));
-				}
+				MOV(16, R(EAX), Imm16(blockSize[start_addr]));
 				JMP(returnDispatcher, true);
 				gpr.loadRegs(false);
 				gpr.flushRegs(c,false);
@@ -361,14 +346,7 @@ void DSPEmitter::Compile(u16 start_addr)
 	}
 
 	gpr.saveRegs();
-	if (!DSPHost::OnThread() && DSPAnalyzer::code_flags[start_addr] & DSPAnalyzer::CODE_IDLE_SKIP)
-	{
-		MOV(16, R(EAX), Imm16(DSP_IDLE_SKIP_CYCLES));
-	}
-	else
-	{
-		MOV(16, R(EAX), Imm16(blockSize[start_addr]));
-	}
+	MOV(16, R(EAX), Imm16(blockSize[start_addr]));
 	JMP(returnDispatcher, true);
 }
 
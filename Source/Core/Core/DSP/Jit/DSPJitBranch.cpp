@@ -73,13 +73,15 @@ static void ReJitConditional(const UDSPInstruction opc, DSPEmitter& emitter)
 	emitter.SetJumpTarget(skipCode);
 }
 
-static void WriteBranchExit(DSPEmitter& emitter)
+// idle_skip gives up the rest of the slice: the block is a wait loop and is
+// jumping back to itself, so nothing will change until the CPU acts.
+static void WriteBranchExit(DSPEmitter& emitter, bool idle_skip = false)
 {
 	DSPJitRegCache c(emitter.gpr);
 	emitter.gpr.saveRegs();
-	if (DSPAnalyzer::code_flags[emitter.startAddr] & DSPAnalyzer::CODE_IDLE_SKIP)
+	if (idle_skip)
 	{
-		emitter.MOV(16, R(EAX), Imm16(0x1000));
+		emitter.MOV(16, R(EAX), M(&cyclesLeft));
 	}
 	else
 	{
@@ -126,7 +128,8 @@ static void r_jcc(const UDSPInstruction opc, DSPEmitter& emitter)
 	if (opcode->uncond_branch)
 		WriteBlockLink(emitter, dest);
 	emitter.MOV(16, M(&(g_dsp.pc)), Imm16(dest));
-	WriteBranchExit(emitter);
+	WriteBranchExit(emitter, dest == emitter.startAddr &&
+	                (DSPAnalyzer::code_flags[dest] & DSPAnalyzer::CODE_IDLE_SKIP));
 }
 // Generic jmp implementation
 // Jcc addressA
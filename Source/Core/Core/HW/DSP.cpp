@@ -456,7 +456,11 @@ static void GenerateDSPInterrupt(u64 DSPIntType, int cyclesLate)
 void GenerateDSPInterruptFromDSPEmu(DSPInterruptType type)
 {
 	CoreTiming::ScheduleEvent_Threadsafe_Immediate(et_GenerateDSPInterrupt, type);
-	CoreTiming::ForceExceptionCheck(100);
+	// The downcount belongs to the CPU thread. From the DSP thread, the event is
+	// picked up at the end of the CPU's current slice instead, so the interrupt
+	// can reach the CPU up to a slice later than from the CPU thread.
+	if (Core::IsCPUThread())
+		CoreTiming::ForceExceptionCheck(100);
 }
 
 // called whenever SystemTimers thinks the dsp deserves a few more cycles
@@ -2,6 +2,8 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstddef>
 #include <map>
 #include <string>
 
@@ -11,6 +13,7 @@
 #endif
 
 #include "Common/Common.h"
+#include "Common/FileUtil.h"
 #include "Common/StringUtil.h"
 #include "Core/PatchEngine.h"
 #include "Core/HLE/HLE.h"
@@ -141,6 +144,10 @@ ps_adds1
 */
 
 static int CODE_SIZE = 1024*1024*32;
+// The code space is filled one generation at a time. Once the current one is
+// full, the oldest generation is emptied and reused instead of throwing away
+// the whole cache, so the hot blocks compiled since then survive.
+static const int CODE_GENERATIONS = 4;
 
 void Jit64::Init()
 {
@@ -177,6 +184,7 @@ void Jit64::Init()
 
 	trampolines.Init();
 	AllocCodeSpace(CODE_SIZE);
+	m_code_generation = 0;
 
 	blocks.Init();
 	asm_routines.Init();
@@ -185,6 +193,16 @@ void Jit64::Init()
 	code_block.m_gpa = &js.gpa;
 	code_block.m_fpa = &js.fpa;
 	analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_CONDITIONAL_CONTINUE);
+	if (Core::g_CoreStartupParameter.bJITInlineFunctions)
+		analyzer.SetOption(PPCAnalyst::PPCAnalyzer::OPTION_LEAF_INLINE);
+
+	const std::string& game_id = Core::g_CoreStartupParameter.m_strUniqueID;
+	if (Core::g_CoreStartupParameter.bJITAnalysisCache && !js.memcheck && !game_id.empty())
+	{
+		if (!File::Exists(File::GetUserPath(D_CACHE_IDX)))
+			File::CreateDir(File::GetUserPath(D_CACHE_IDX));
+		analyzer.OpenCache(StringFromFormat("%sjit-%s-analysis.cache", File::GetUserPath(D_CACHE_IDX).c_str(), game_id.c_str()));
+	}
 }
 
 void Jit64::ClearCache()
@@ -192,11 +210,30 @@ void Jit64::ClearCache()
 	blocks.Clear();
 	trampolines.ClearCodeSpace();
 	ClearCodeSpace();
+	m_code_generation = 0;
+}
+
+u8* Jit64::GetCodeGenerationEnd() const
+{
+	return region + (m_code_generation + 1) * (region_size / CODE_GENERATIONS);
+}
+
+bool Jit64::EvictOldestCodeGeneration()
+{
+	m_code_generation = (m_code_generation + 1) % CODE_GENERATIONS;
+	u8* start = region + m_code_generation * (region_size / CODE_GENERATIONS);
+	u8* end = GetCodeGenerationEnd();
+
+	int evicted = blocks.EvictBlocksInCodeRange(start, end);
+	SetCodePtr(start);
+	DEBUG_LOG(DYNA_REC, "Evicted %d blocks from code generation %d", evicted, m_code_generation);
+	return !blocks.IsFull();
 }
 
 void Jit64::Shutdown()
 {
 	FreeCodeSpace();
+	analyzer.CloseCache();
 
 	blocks.Shutdown();
 	trampolines.Shutdown();
@@ -288,21 +325,160 @@ void Jit64::WriteExit(u32 destination)
 	linkData.exitPtrs = GetWritableCodePtr();
 	linkData.linkStatus = false;
 
-	// Link opportunity!
-	int block;
-	if (jo.enableBlocklink && (block = blocks.GetBlockNumberFromStartAddress(destination)) >= 0)
+	// FinalizeBlock links the exit by writing a JMP over the start of this.
+	// Unlinking writes it back, so the exit must always have this size.
+	MOV(32, M(&PC), Imm32(destination));
+	JMP(asm_routines.dispatcher, true);
+
+	b->linkData.push_back(linkData);
+}
+
+void Jit64::WriteBranchExit(u32 destination, FlushMode mode)
+{
+	// The branch back of a loop block leaves the cache state alone: if code
+	// follows it, it is the not-taken path, which still has the registers.
+	if (m_loop_start && destination == js.blockStart)
 	{
-		// It exists! Joy of joy!
-		JMP(blocks.GetBlock(block)->checkedEntry, true);
-		linkData.linkStatus = true;
+		WriteLoopBackEdge();
+		return;
 	}
-	else
+
+	gpr.Flush(mode);
+	fpr.Flush(mode);
+	WriteExit(destination);
+}
+
+// Callee saved, so that the calls in Cleanup() don't clobber them.
+// R12 is left out, like it's last in the register cache's allocation order:
+// as a base register it needs a SIB byte, which some emitters don't expect.
+static const X64Reg s_loop_xregs[] =
+{
+#ifdef _WIN32
+	RSI, RDI, R13, R14,
+#else
+	RBP, R13, R14,
+#endif
+};
+
+static bool BranchesTo(const PPCAnalyst::CodeOp& op, u32 address)
+{
+	UGeckoInstruction inst = op.inst;
+	if (inst.OPCD == 18 && !inst.LK) // bx
+		return (inst.AA ? 0 : op.address) + SignExt26(inst.LI << 2) == address;
+	if (inst.OPCD == 16 && !inst.LK) // bcx
+		return (inst.AA ? 0 : op.address) + SignExt16(inst.BD << 2) == address;
+	return false;
+}
+
+void Jit64::SetupLoopRegisters(const PPCAnalyst::CodeOp* ops, u32 num_instructions)
+{
+	m_loop_regs.clear();
+	m_loop_start = nullptr;
+
+	// Profiling counts block entries, and memchecks exit after each load and store.
+	if (!jo.enableBlocklink || js.memcheck || Profiler::g_ProfileBlocks)
+		return;
+
+	bool loops = false;
+	int uses[32] = {};
+	bool live_in[32] = {};
+	bool written[32] = {};
+	for (u32 i = 0; i < num_instructions; i++)
 	{
-		MOV(32, M(&PC), Imm32(destination));
-		JMP(asm_routines.dispatcher, true);
+		const PPCAnalyst::CodeOp& op = ops[i];
+		if (op.skip)
+			continue;
+		loops |= BranchesTo(op, js.blockStart);
+		for (s8 reg : op.regsIn)
+		{
+			if (reg < 0)
+				continue;
+			uses[reg]++;
+			live_in[reg] |= !written[reg];
+		}
+		for (s8 reg : op.regsOut)
+		{
+			if (reg < 0)
+				continue;
+			uses[reg]++;
+			written[reg] = true;
+		}
 	}
+	if (!loops)
+		return;
 
-	b->linkData.push_back(linkData);
+	// Registers that carry a value from one iteration to the next gain the
+	// most, as they would otherwise be stored and loaded every time around.
+	std::vector<size_t> candidates;
+	for (size_t i = 0; i < 32; i++)
+	{
+		if (uses[i])
+			candidates.push_back(i);
+	}
+	std::stable_sort(candidates.begin(), candidates.end(), [&](size_t a, size_t b) {
+		if (live_in[a] != live_in[b])
+			return live_in[a];
+		return uses[a] > uses[b];
+	});
+
+	for (size_t i = 0; i < candidates.size() && i < ArraySize(s_loop_xregs); i++)
+	{
+		LoopReg reg = { candidates[i], s_loop_xregs[i] };
+		gpr.BindToSpecificRegister(reg.preg, reg.xreg);
+		m_loop_regs.push_back(reg);
+	}
+
+	// A loop without registers, like an idle "b .", is left to the normal exit.
+	if (!m_loop_regs.empty())
+		m_loop_start = GetCodePtr();
+}
+
+bool Jit64::IsLoopRegister(size_t preg) const
+{
+	for (const LoopReg& reg : m_loop_regs)
+	{
+		if (reg.preg == preg)
+			return true;
+	}
+	return false;
+}
+
+void Jit64::WriteLoopBackEdge()
+{
+	// Make the registers look like they do at m_loop_start: the loop
+	// registers in their host registers, everything else in memory.
+	for (size_t i = 0; i < 32; i++)
+	{
+		if (!IsLoopRegister(i))
+			gpr.StoreFromRegister(i, FLUSH_MAINTAIN_STATE);
+	}
+	fpr.Flush(FLUSH_MAINTAIN_STATE);
+
+	// Something in the loop may have evicted or moved a loop register.
+	for (const LoopReg& reg : m_loop_regs)
+	{
+		if (gpr.IsBound(reg.preg) && gpr.RX(reg.preg) != reg.xreg)
+			gpr.StoreFromRegister(reg.preg, FLUSH_MAINTAIN_STATE);
+	}
+	for (const LoopReg& reg : m_loop_regs)
+	{
+		if (gpr.IsBound(reg.preg) && gpr.RX(reg.preg) == reg.xreg)
+			continue;
+		if (gpr.R(reg.preg).IsImm())
+			MOV(32, R(reg.xreg), gpr.R(reg.preg));
+		else
+			MOV(32, R(reg.xreg), gpr.GetDefaultLocation(reg.preg));
+	}
+
+	Cleanup();
+	SUB(32, M(&PowerPC::ppcState.downcount), Imm32(js.downcountAmount));
+	J_CC(CC_NBE, m_loop_start);
+
+	// The timeslice is over: leave through the checked entry's path.
+	for (const LoopReg& reg : m_loop_regs)
+		MOV(32, gpr.GetDefaultLocation(reg.preg), R(reg.xreg));
+	MOV(32, M(&PC), Imm32(js.blockStart));
+	JMP(asm_routines.doTiming, true);
 }
 
 void Jit64::WriteExitDestInEAX()
@@ -310,7 +486,24 @@ void Jit64::WriteExitDestInEAX()
 	MOV(32, M(&PC), R(EAX));
 	Cleanup();
 	SUB(32, M(&PowerPC::ppcState.downcount), Imm32(js.downcountAmount));
-	JMP(asm_routines.dispatcher, true);
+	if (!jo.enableBlocklink)
+	{
+		JMP(asm_routines.dispatcher, true);
+		return;
+	}
+
+	// Look the destination up in the table the dispatcher fills, so that
+	// returns and other indirect branches to hot code skip the dispatcher.
+	J_CC(CC_BE, asm_routines.doTiming);
+	MOV(32, R(EAX), M(&PC));
+	MOV(32, R(ECX), R(EAX));
+	AND(32, R(ECX), Imm32((JitBaseBlockCache::FAST_LOOKUP_SIZE - 1) << 2));
+	MOV(64, R(RSI), Imm64((u64)blocks.GetFastLookupTable()));
+	CMP(32, MComplex(RSI, RCX, SCALE_4, offsetof(FastLookupEntry, address)), R(EAX));
+	FixupBranch miss = J_CC(CC_NE);
+	JMPptr(MComplex(RSI, RCX, SCALE_4, offsetof(FastLookupEntry, code)));
+	SetJumpTarget(miss);
+	JMP(asm_routines.dispatcherPcInEAX, true);
 }
 
 void Jit64::WriteRfiExitDestInEAX()
@@ -380,10 +573,15 @@ void Jit64::Trace()
 
 void STACKALIGN Jit64::Jit(u32 em_address)
 {
-	if (GetSpaceLeft() < 0x10000 || blocks.IsFull() || Core::g_CoreStartupParameter.bJITNoBlockCache)
+	if (trampolines.GetSpaceLeft() < 0x10000 || Core::g_CoreStartupParameter.bJITNoBlockCache)
 	{
 		ClearCache();
 	}
+	else if (GetCodeGenerationEnd() - GetCodePtr() < 0x10000 || blocks.IsFull())
+	{
+		if (!EvictOldestCodeGeneration())
+			ClearCache();
+	}
 
 	int block_num = blocks.AllocateBlock(em_address);
 	JitBlock *b = blocks.GetBlock(block_num);
@@ -459,6 +657,7 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 	// They use the information in gpa/fpa to preload commonly used registers.
 	gpr.Start();
 	fpr.Start();
+	SetupLoopRegisters(ops, code_block.m_num_instructions);
 
 	js.downcountAmount = 0;
 	if (!Core::g_CoreStartupParameter.bEnableDebugging)
@@ -493,7 +692,8 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 		else
 		{
 			// help peephole optimizations
-			js.next_inst = ops[i + 1].inst;
+			// A skipped instruction, like the blr of an inlined function, doesn't really come next.
+			js.next_inst = ops[i + 1].skip ? 0 : ops[i + 1].inst;
 			js.next_compilerPC = ops[i + 1].address;
 		}
 
@@ -664,6 +864,7 @@ const u8* Jit64::DoJit(u32 em_address, PPCAnalyst::CodeBuffer *code_buf, JitBloc
 
 	b->codeSize = (u32)(GetCodePtr() - normalEntry);
 	b->originalSize = code_block.m_num_instructions;
+	b->inlinedFunctions = code_block.m_inlined_functions;
 
 #ifdef JIT_LOG_X86
 	LogGeneratedX86(code_block.m_num_instructions, code_buf, normalEntry, b);
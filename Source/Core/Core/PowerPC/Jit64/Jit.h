@@ -48,8 +48,32 @@ private:
 	PPCAnalyst::CodeBuffer code_buffer;
 	Jit64AsmRoutineManager asm_routines;
 
+	// Index of the part of the code space blocks are currently compiled into.
+	int m_code_generation;
+	u8* GetCodeGenerationEnd() const;
+	// Destroys the blocks of the next generation and continues compiling there.
+	// Returns false if that didn't free up a block slot.
+	bool EvictOldestCodeGeneration();
+
+	// A block that branches back to its own start keeps its most used guest
+	// registers in fixed host registers across that branch, instead of
+	// storing them at the end of each iteration and loading them again.
+	struct LoopReg
+	{
+		size_t preg;
+		Gen::X64Reg xreg;
+	};
+	std::vector<LoopReg> m_loop_regs;
+	// Where the branch back goes, after the loop registers are loaded.
+	// nullptr if the block isn't compiled as a loop.
+	const u8* m_loop_start;
+
+	void SetupLoopRegisters(const PPCAnalyst::CodeOp* ops, u32 num_instructions);
+	bool IsLoopRegister(size_t preg) const;
+	void WriteLoopBackEdge();
+
 public:
-	Jit64() : code_buffer(32000) {}
+	Jit64() : code_buffer(32000), m_code_generation(0), m_loop_start(nullptr) {}
 	~Jit64() {}
 
 	void Init() override;
@@ -90,6 +114,8 @@ public:
 	// Utilities for use by opcodes
 
 	void WriteExit(u32 destination);
+	// Flushes the register caches with mode, then exits to destination.
+	void WriteBranchExit(u32 destination, FlushMode mode);
 	void WriteExitDestInEAX();
 	void WriteExceptionExit();
 	void WriteExternalExceptionExit();
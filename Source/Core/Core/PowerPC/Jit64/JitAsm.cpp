@@ -2,6 +2,8 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <cstddef>
+
 #include "Common/MemoryUtil.h"
 
 #include "Core/PowerPC/Jit64/Jit.h"
@@ -125,8 +127,15 @@ void Jit64AsmRoutineManager::Generate()
 				{
 					ADD(32, M(&PowerPC::ppcState.DebugCount), Imm8(1));
 				}
-				//grab from list and jump to it
-				JMPptr(MComplex(R15, RAX, 8, 0));
+				//grab from list, remember it for the indirect branches and jump to it
+				MOV(32, R(ECX), M(&PowerPC::ppcState.pc));
+				MOV(32, R(EDX), R(ECX));
+				AND(32, R(EDX), Imm32((JitBaseBlockCache::FAST_LOOKUP_SIZE - 1) << 2));
+				MOV(64, R(RSI), Imm64((u64)jit->GetBlockCache()->GetFastLookupTable()));
+				MOV(32, MComplex(RSI, RDX, SCALE_4, offsetof(FastLookupEntry, address)), R(ECX));
+				MOV(64, R(RCX), MComplex(R15, RAX, 8, 0));
+				MOV(64, MComplex(RSI, RDX, SCALE_4, offsetof(FastLookupEntry, code)), R(RCX));
+				JMPptr(R(RCX));
 			SetJumpTarget(notfound);
 
 			//Ok, no block, let's jit
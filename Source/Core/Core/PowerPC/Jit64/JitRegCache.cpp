@@ -265,6 +265,21 @@ void RegCache::BindToRegister(size_t i, bool doLoad, bool makeDirty)
 	}
 }
 
+void RegCache::BindToSpecificRegister(size_t i, X64Reg xr)
+{
+	if (regs[i].away)
+		PanicAlert("PPC reg %" PRIx64 " is already cached", i);
+	if (!IsFreeX(xr))
+		PanicAlert("X64 reg %i is not free", xr);
+
+	xregs[xr].free = false;
+	xregs[xr].ppcReg = i;
+	xregs[xr].dirty = true;
+	LoadRegister(i, xr);
+	regs[i].away = true;
+	regs[i].location = ::Gen::R(xr);
+}
+
 void RegCache::StoreFromRegister(size_t i, FlushMode mode)
 {
 	if (regs[i].away)
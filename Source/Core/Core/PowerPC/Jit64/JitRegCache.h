@@ -83,6 +83,8 @@ public:
 	//TODO - instead of doload, use "read", "write"
 	//read only will not set dirty flag
 	void BindToRegister(size_t preg, bool doLoad = true, bool makeDirty = true);
+	// Loads preg into xr, which must be free, and marks it dirty.
+	void BindToSpecificRegister(size_t preg, Gen::X64Reg xr);
 	void StoreFromRegister(size_t preg, FlushMode mode = FLUSH_ALL);
 	virtual void StoreRegister(size_t preg, Gen::OpArg newLoc) = 0;
 	virtual void LoadRegister(size_t preg, Gen::X64Reg newLoc) = 0;
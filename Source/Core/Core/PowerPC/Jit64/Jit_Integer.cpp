@@ -387,9 +387,6 @@ void Jit64::cmpXX(UGeckoInstruction inst)
 			u8 conditionResult = (js.next_inst.BO & BO_BRANCH_IF_TRUE) ? test_bit : 0;
 			if ((compareResult & test_bit) == conditionResult)
 			{
-				gpr.Flush();
-				fpr.Flush();
-
 				if (js.next_inst.OPCD == 16) // bcx
 				{
 					if (js.next_inst.LK)
@@ -400,10 +397,12 @@ void Jit64::cmpXX(UGeckoInstruction inst)
 						destination = SignExt16(js.next_inst.BD << 2);
 					else
 						destination = js.next_compilerPC + SignExt16(js.next_inst.BD << 2);
-					WriteExit(destination);
+					WriteBranchExit(destination, FLUSH_ALL);
 				}
 				else if ((js.next_inst.OPCD == 19) && (js.next_inst.SUBOP10 == 528)) // bcctrx
 				{
+					gpr.Flush();
+					fpr.Flush();
 					if (js.next_inst.LK)
 						MOV(32, M(&LR), Imm32(js.compilerPC + 4));
 					MOV(32, R(EAX), M(&CTR));
@@ -412,6 +411,8 @@ void Jit64::cmpXX(UGeckoInstruction inst)
 				}
 				else if ((js.next_inst.OPCD == 19) && (js.next_inst.SUBOP10 == 16)) // bclrx
 				{
+					gpr.Flush();
+					fpr.Flush();
 					MOV(32, R(EAX), M(&LR));
 					if (js.next_inst.LK)
 						MOV(32, M(&LR), Imm32(js.compilerPC + 4));
@@ -485,9 +486,6 @@ void Jit64::cmpXX(UGeckoInstruction inst)
 			else  // SO bit, do not branch (we don't emulate SO for cmp).
 				pDontBranch = J(true);
 
-			gpr.Flush(FLUSH_MAINTAIN_STATE);
-			fpr.Flush(FLUSH_MAINTAIN_STATE);
-
 			// Code that handles successful PPC branching.
 			if (js.next_inst.OPCD == 16) // bcx
 			{
@@ -499,10 +497,12 @@ void Jit64::cmpXX(UGeckoInstruction inst)
 					destination = SignExt16(js.next_inst.BD << 2);
 				else
 					destination = js.next_compilerPC + SignExt16(js.next_inst.BD << 2);
-				WriteExit(destination);
+				WriteBranchExit(destination, FLUSH_MAINTAIN_STATE);
 			}
 			else if ((js.next_inst.OPCD == 19) && (js.next_inst.SUBOP10 == 528)) // bcctrx
 			{
+				gpr.Flush(FLUSH_MAINTAIN_STATE);
+				fpr.Flush(FLUSH_MAINTAIN_STATE);
 				if (js.next_inst.LK)
 					MOV(32, M(&LR), Imm32(js.compilerPC + 4));
 
@@ -512,6 +512,8 @@ void Jit64::cmpXX(UGeckoInstruction inst)
 			}
 			else if ((js.next_inst.OPCD == 19) && (js.next_inst.SUBOP10 == 16)) // bclrx
 			{
+				gpr.Flush(FLUSH_MAINTAIN_STATE);
+				fpr.Flush(FLUSH_MAINTAIN_STATE);
 				MOV(32, R(EAX), M(&LR));
 				AND(32, R(EAX), Imm32(0xFFFFFFFC));
 
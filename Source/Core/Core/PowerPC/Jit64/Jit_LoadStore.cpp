@@ -123,6 +123,9 @@ void Jit64::lXXx(UGeckoInstruction inst)
 
 		ABI_PopRegistersAndAdjustStack(registersInUse, false);
 
+		gpr.Flush(FLUSH_MAINTAIN_STATE);
+		fpr.Flush(FLUSH_MAINTAIN_STATE);
+
 		// ! we must continue executing of the loop after exception handling, maybe there is still 0 in r0
 		//MOV(32, M(&PowerPC::ppcState.pc), Imm32(js.compilerPC));
 		WriteExceptionExit();
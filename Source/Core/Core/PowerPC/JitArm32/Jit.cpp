@@ -201,22 +201,13 @@ void JitArm::WriteExit(u32 destination)
 	linkData.exitPtrs = GetWritableCodePtr();
 	linkData.linkStatus = false;
 
-	// Link opportunity!
-	int block;
-	if (jo.enableBlocklink && (block = blocks.GetBlockNumberFromStartAddress(destination)) >= 0)
-	{
-		// It exists! Joy of joy!
-		B(blocks.GetBlock(block)->checkedEntry);
-		linkData.linkStatus = true;
-	}
-	else
-	{
-		ARMReg A = gpr.GetReg(false);
-		MOVI2R(A, destination);
-		STR(A, R9, PPCSTATE_OFF(pc));
-		MOVI2R(A, (u32)asm_routines.dispatcher);
-		B(A);
-	}
+	// FinalizeBlock links the exit by writing a B over the start of this.
+	// Unlinking writes it back, so the exit must always have this size.
+	ARMReg A = gpr.GetReg(false);
+	MOVI2R(A, destination);
+	STR(A, R9, PPCSTATE_OFF(pc));
+	MOVI2R(A, (u32)asm_routines.dispatcher);
+	B(A);
 
 	b->linkData.push_back(linkData);
 }
@@ -9,6 +9,8 @@
 // performance hit, it's not enabled by default, but it's useful for
 // locating performance issues.
 
+#include <algorithm>
+
 #include "disasm.h"
 
 #include "Common/Common.h"
@@ -36,7 +38,7 @@ using namespace Gen;
 
 	bool JitBaseBlockCache::IsFull() const
 	{
-		return GetNumBlocks() >= MAX_NUM_BLOCKS - 1;
+		return GetNumBlocks() >= MAX_NUM_BLOCKS - 1 && free_blocks.empty();
 	}
 
 	void JitBaseBlockCache::Init()
@@ -46,6 +48,8 @@ using namespace Gen;
 #endif
 		blocks = new JitBlock[MAX_NUM_BLOCKS];
 		blockCodePointers = new const u8*[MAX_NUM_BLOCKS];
+		block_pages.reset(new std::vector<int>[NUM_BLOCK_PAGES]);
+		fast_lookup.reset(new FastLookupEntry[FAST_LOOKUP_SIZE]);
 		if (iCache == nullptr && iCacheEx == nullptr && iCacheVMEM == nullptr)
 		{
 			iCache = new u8[JIT_ICACHE_SIZE];
@@ -81,6 +85,8 @@ using namespace Gen;
 		iCacheVMEM = nullptr;
 		blocks = nullptr;
 		blockCodePointers = nullptr;
+		block_pages.reset();
+		fast_lookup.reset();
 		num_blocks = 0;
 #if defined USE_OPROFILE && USE_OPROFILE
 		op_close_agent(agent);
@@ -107,12 +113,14 @@ using namespace Gen;
 			DestroyBlock(i, false);
 		}
 		links_to.clear();
-		block_map.clear();
+		free_blocks.clear();
 
 		valid_block.ClearAll();
 
 		num_blocks = 0;
 		memset(blockCodePointers, 0, sizeof(u8*)*MAX_NUM_BLOCKS);
+		for (u32 i = 0; i < FAST_LOOKUP_SIZE; i++)
+			fast_lookup[i].address = FAST_LOOKUP_INVALID_ADDRESS;
 	}
 
 	void JitBaseBlockCache::Reset()
@@ -145,12 +153,41 @@ using namespace Gen;
 
 	int JitBaseBlockCache::AllocateBlock(u32 em_address)
 	{
-		JitBlock &b = blocks[num_blocks];
+		int block_num;
+		if (!free_blocks.empty())
+		{
+			// Reuse the slot of a destroyed block.
+			block_num = free_blocks.back();
+			free_blocks.pop_back();
+		}
+		else
+		{
+			block_num = num_blocks;
+			num_blocks++; //commit the current block
+		}
+		JitBlock &b = blocks[block_num];
 		b.invalid = false;
 		b.originalAddress = em_address;
 		b.linkData.clear();
-		num_blocks++; //commit the current block
-		return num_blocks - 1;
+		b.inlinedFunctions.clear();
+		return block_num;
+	}
+
+	// Calls f(start, size) with each physical address range that block b was
+	// compiled from: its own code, then that of the functions inlined into it.
+	template <typename F>
+	static void ForEachBlockRange(const JitBlock &b, F f)
+	{
+		f(b.originalAddress & 0x1FFFFFFF, std::max<u32>(b.originalSize, 1) * 4);
+		for (const auto& func : b.inlinedFunctions)
+			f(func.first & 0x1FFFFFFF, func.second * 4);
+	}
+
+	// Physical page range [first, last] covered by [start, start + size).
+	static void GetRangePages(u32 start, u32 size, u32 shift, u32* first, u32* last)
+	{
+		*first = start >> shift;
+		*last = std::min<u32>(start + size - 1, 0x1FFFFFFF) >> shift;
 	}
 
 	void JitBaseBlockCache::FinalizeBlock(int block_num, bool block_link, const u8 *code_ptr)
@@ -160,18 +197,20 @@ using namespace Gen;
 		u32* icp = GetICachePtr(b.originalAddress);
 		*icp = block_num;
 
-		// Convert the logical address to a physical address for the block map
-		u32 pAddr = b.originalAddress & 0x1FFFFFFF;
-
-		for (u32 i = 0; i < (b.originalSize + 7) / 8; ++i)
-			valid_block.Set(pAddr / 32 + i);
+		// Mark the 32 byte lines of the block's code in the block map
+		ForEachBlockRange(b, [&](u32 start, u32 size) {
+			u32 first, last;
+			GetRangePages(start, size, 5, &first, &last);
+			for (u32 line = first; line <= last; ++line)
+				valid_block.Set(line);
+		});
 
-		block_map[std::make_pair(pAddr + 4 * b.originalSize - 1, pAddr)] = block_num;
+		AddBlockToPages(block_num);
 		if (block_link)
 		{
 			for (const auto& e : b.linkData)
 			{
-				links_to.insert(std::pair<u32, int>(e.exitAddress, block_num));
+				links_to[e.exitAddress].push_back(block_num);
 			}
 
 			LinkBlock(block_num);
@@ -206,6 +245,11 @@ using namespace Gen;
 		return blockCodePointers;
 	}
 
+	FastLookupEntry *JitBaseBlockCache::GetFastLookupTable()
+	{
+		return fast_lookup.get();
+	}
+
 	u32* JitBaseBlockCache::GetICachePtr(u32 addr)
 	{
 		if (addr & JIT_ICACHE_VMEM_BIT)
@@ -268,38 +312,92 @@ using namespace Gen;
 	{
 		LinkBlockExits(i);
 		JitBlock &b = blocks[i];
-		// equal_range(b) returns pair<iterator,iterator> representing the range
-		// of element with key b
-		auto ppp = links_to.equal_range(b.originalAddress);
+		auto sources = links_to.find(b.originalAddress);
 
-		if (ppp.first == ppp.second)
+		if (sources == links_to.end())
 			return;
 
-		for (auto iter = ppp.first; iter != ppp.second; ++iter)
+		for (int source : sources->second)
 		{
-			// PanicAlert("Linking block %i to block %i", iter->second, i);
-			LinkBlockExits(iter->second);
+			// PanicAlert("Linking block %i to block %i", source, i);
+			LinkBlockExits(source);
 		}
 	}
 
 	void JitBaseBlockCache::UnlinkBlock(int i)
 	{
 		JitBlock &b = blocks[i];
-		auto ppp = links_to.equal_range(b.originalAddress);
+		auto sources = links_to.find(b.originalAddress);
 
-		if (ppp.first == ppp.second)
+		if (sources == links_to.end())
 			return;
 
-		for (auto iter = ppp.first; iter != ppp.second; ++iter)
+		for (int source : sources->second)
 		{
-			JitBlock &sourceBlock = blocks[iter->second];
+			JitBlock &sourceBlock = blocks[source];
+			// The code of a dead block may already have been overwritten.
+			if (sourceBlock.invalid)
+				continue;
 			for (auto& e : sourceBlock.linkData)
 			{
-				if (e.exitAddress == b.originalAddress)
+				if (e.exitAddress == b.originalAddress && e.linkStatus)
+				{
+					// Point the exit back at the dispatcher, so that nothing jumps
+					// into this block's code once its space gets reused.
+					WriteDestroyBlock(e.exitPtrs, e.exitAddress);
 					e.linkStatus = false;
+				}
 			}
 		}
-		links_to.erase(b.originalAddress);
+		// The sources stay listed, so they're linked again when a block at
+		// this address is compiled.
+	}
+
+	void JitBaseBlockCache::RemoveBlockFromLinks(int i)
+	{
+		for (const auto& e : blocks[i].linkData)
+		{
+			auto sources = links_to.find(e.exitAddress);
+			if (sources == links_to.end())
+				continue;
+			std::vector<int>& source_blocks = sources->second;
+			source_blocks.erase(std::remove(source_blocks.begin(), source_blocks.end(), i), source_blocks.end());
+			if (source_blocks.empty())
+				links_to.erase(sources);
+		}
+	}
+
+	void JitBaseBlockCache::AddBlockToPages(int i)
+	{
+		ForEachBlockRange(blocks[i], [&](u32 start, u32 size) {
+			u32 first, last;
+			GetRangePages(start, size, BLOCK_PAGE_SHIFT, &first, &last);
+			for (u32 page = first; page <= last; ++page)
+			{
+				// An inlined function can be in a page the block is already listed in.
+				std::vector<int>& page_blocks = block_pages[page];
+				if (page_blocks.empty() || page_blocks.back() != i)
+					page_blocks.push_back(i);
+			}
+		});
+	}
+
+	void JitBaseBlockCache::RemoveBlockFromPages(int i)
+	{
+		ForEachBlockRange(blocks[i], [&](u32 start, u32 size) {
+			u32 first, last;
+			GetRangePages(start, size, BLOCK_PAGE_SHIFT, &first, &last);
+			for (u32 page = first; page <= last; ++page)
+			{
+				std::vector<int>& page_blocks = block_pages[page];
+				auto it = std::find(page_blocks.begin(), page_blocks.end(), i);
+				if (it != page_blocks.end())
+				{
+					*it = page_blocks.back();
+					page_blocks.pop_back();
+				}
+			}
+		});
 	}
 
 	void JitBaseBlockCache::DestroyBlock(int block_num, bool invalidate)
@@ -319,7 +417,14 @@ using namespace Gen;
 		b.invalid = true;
 		*GetICachePtr(b.originalAddress) = JIT_ICACHE_INVALID_WORD;
 
+		// The dispatcher may have filled the slot with a mirror of the address,
+		// which maps to the same slot, so don't compare the address.
+		fast_lookup[(b.originalAddress >> 2) & (FAST_LOOKUP_SIZE - 1)].address = FAST_LOOKUP_INVALID_ADDRESS;
+
 		UnlinkBlock(block_num);
+		RemoveBlockFromLinks(block_num);
+		RemoveBlockFromPages(block_num);
+		free_blocks.push_back(block_num);
 
 		// Send anyone who tries to run this block back to the dispatcher.
 		// Not entirely ideal, but .. pretty good.
@@ -327,6 +432,21 @@ using namespace Gen;
 		WriteDestroyBlock(b.checkedEntry, b.originalAddress);
 	}
 
+	int JitBaseBlockCache::EvictBlocksInCodeRange(const u8* start, const u8* end)
+	{
+		int evicted = 0;
+		for (int i = 0; i < num_blocks; i++)
+		{
+			JitBlock &b = blocks[i];
+			if (!b.invalid && b.checkedEntry >= start && b.checkedEntry < end)
+			{
+				DestroyBlock(i, false);
+				evicted++;
+			}
+		}
+		return evicted;
+	}
+
 	void JitBaseBlockCache::InvalidateICache(u32 address, const u32 length)
 	{
 		// Convert the logical address to a physical address for the block map
@@ -343,20 +463,31 @@ using namespace Gen;
 		}
 
 		// destroy JIT blocks
-		// !! this works correctly under assumption that any two overlapping blocks end at the same address
-		if (destroy_block)
+		// Only the pages the range touches are looked at; a block spanning several
+		// pages is listed in each of them.
+		if (destroy_block && length != 0)
 		{
-			std::map<std::pair<u32,u32>, u32>::iterator it1 = block_map.lower_bound(std::make_pair(pAddr, 0)), it2 = it1;
-			while (it2 != block_map.end() && it2->first.second < pAddr + length)
-			{
-				JitBlock &b = blocks[it2->second];
-				*GetICachePtr(b.originalAddress) = JIT_ICACHE_INVALID_WORD;
-				DestroyBlock(it2->second, true);
-				++it2;
-			}
-			if (it1 != it2)
+			u32 end = std::min<u32>(pAddr + length, 0x20000000);
+			for (u32 page = pAddr >> BLOCK_PAGE_SHIFT; page <= (end - 1) >> BLOCK_PAGE_SHIFT; ++page)
 			{
-				block_map.erase(it1, it2);
+				std::vector<int>& page_blocks = block_pages[page];
+				size_t i = 0;
+				while (i < page_blocks.size())
+				{
+					bool overlaps = false;
+					ForEachBlockRange(blocks[page_blocks[i]], [&](u32 start, u32 size) {
+						overlaps |= start < end && start + size > pAddr;
+					});
+					if (overlaps)
+					{
+						// Removes the block from page_blocks, replacing it with the last one.
+						DestroyBlock(page_blocks[i], true);
+					}
+					else
+					{
+						++i;
+					}
+				}
 			}
 		}
 	}
@@ -5,8 +5,9 @@
 #pragma once
 
 #include <bitset>
-#include <map>
 #include <memory>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "Core/PowerPC/Gekko.h"
@@ -40,6 +41,10 @@ struct JitBlock
 	u32 originalSize;
 	int runCount;  // for profiling.
 
+	// Functions compiled into the block, as (address, number of instructions)
+	// pairs. Changes to their code invalidate the block too.
+	std::vector<std::pair<u32, u32>> inlinedFunctions;
+
 	bool invalid;
 
 	struct LinkData
@@ -65,6 +70,19 @@ struct JitBlock
 
 typedef void (*CompiledCode)();
 
+// An entry of the table indirect branches look their destination up in
+// before falling back to the dispatcher.
+struct FastLookupEntry
+{
+	u32 address;
+	u32 padding;
+	// A host code pointer, written by the JIT. It's always 64 bits wide, so
+	// that the entry has the same layout on 32-bit hosts.
+	u64 code;
+};
+// The JIT scales the index of an entry by 4 after masking the address.
+static_assert(sizeof(FastLookupEntry) == 16, "FastLookupEntry should be 16 bytes");
+
 // This is essentially just an std::bitset, but Visual Studia 2013's
 // implementation of std::bitset is slow.
 class ValidBlockBitSet final
@@ -109,25 +127,40 @@ class JitBaseBlockCache
 	const u8 **blockCodePointers;
 	JitBlock *blocks;
 	int num_blocks;
-	std::multimap<u32, int> links_to;
-	std::map<std::pair<u32,u32>, u32> block_map; // (end_addr, start_addr) -> number
+	std::vector<int> free_blocks; // slots of destroyed blocks, reused by AllocateBlock
+	std::unordered_map<u32, std::vector<int>> links_to; // exit address -> blocks jumping there
+	// For each 4 KiB page of physical memory, the valid blocks with code in it.
+	std::unique_ptr<std::vector<int>[]> block_pages;
 	ValidBlockBitSet valid_block;
+	std::unique_ptr<FastLookupEntry[]> fast_lookup;
 
 	enum
 	{
 		MAX_NUM_BLOCKS = 65536*2,
+		BLOCK_PAGE_SHIFT = 12,
+		NUM_BLOCK_PAGES = 0x20000000 >> BLOCK_PAGE_SHIFT,
 	};
 
 	bool RangeIntersect(int s1, int e1, int s2, int e2) const;
 	void LinkBlockExits(int i);
 	void LinkBlock(int i);
 	void UnlinkBlock(int i);
+	void RemoveBlockFromLinks(int i);
+	void AddBlockToPages(int i);
+	void RemoveBlockFromPages(int i);
 
 	// Virtual for overloaded
 	virtual void WriteLinkBlock(u8* location, const u8* address) = 0;
 	virtual void WriteDestroyBlock(const u8* location, u32 address) = 0;
 
 public:
+	enum
+	{
+		// Direct mapped, indexed by (address >> 2) & (FAST_LOOKUP_SIZE - 1).
+		FAST_LOOKUP_SIZE = 0x1000,
+		FAST_LOOKUP_INVALID_ADDRESS = 0xFFFFFFFF,
+	};
+
 	JitBaseBlockCache() :
 		blockCodePointers(nullptr), blocks(nullptr), num_blocks(0),
 		iCache(nullptr), iCacheEx(nullptr), iCacheVMEM(nullptr)
@@ -148,6 +181,9 @@ public:
 	JitBlock *GetBlock(int block_num);
 	int GetNumBlocks() const;
 	const u8 **GetCodePointers();
+	// Filled by the dispatcher with the normalEntry of the blocks it finds.
+	// Entries are cleared when their block is destroyed.
+	FastLookupEntry *GetFastLookupTable();
 	u8 *iCache;
 	u8 *iCacheEx;
 	u8 *iCacheVMEM;
@@ -163,6 +199,10 @@ public:
 	// DOES NOT WORK CORRECTLY WITH INLINING
 	void InvalidateICache(u32 address, const u32 length);
 	void DestroyBlock(int block_num, bool invalidate);
+
+	// Destroys every valid block whose code starts in [start, end), so that the
+	// range can be written over. Returns the number of blocks destroyed.
+	int EvictBlocksInCodeRange(const u8* start, const u8* end);
 };
 
 // x86 BlockCache
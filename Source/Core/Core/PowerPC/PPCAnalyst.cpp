@@ -4,11 +4,15 @@
 
 #include <queue>
 #include <string>
+#include <unordered_map>
 
+#include "Common/Hash.h"
+#include "Common/LinearDiskCache.h"
 #include "Common/StringUtil.h"
 
 #include "Core/ConfigManager.h"
 #include "Core/GeckoCode.h"
+#include "Core/HLE/HLE.h"
 #include "Core/HW/Memmap.h"
 #include "Core/PowerPC/JitInterface.h"
 #include "Core/PowerPC/PPCAnalyst.h"
@@ -33,6 +37,8 @@ namespace PPCAnalyst
 static const int CODEBUFFER_SIZE = 32000;
 // 0 does not perform block merging
 static const u32 FUNCTION_FOLLOWING_THRESHOLD = 16;
+// Largest function that is inlined, in instructions, including its blr.
+static const u32 INLINE_FUNCTION_MAX_SIZE = 32;
 
 CodeBuffer::CodeBuffer(int size)
 {
@@ -524,6 +530,187 @@ void PPCAnalyzer::SetInstructionStats(CodeBlock *block, CodeOp *code, GekkoOPInf
 	}
 }
 
+#pragma pack(push, 1)
+struct AnalysisCacheKey
+{
+	u32 address;
+	u32 block_size;
+	u32 options;
+	u32 num_instructions;
+	u64 hash; // of the instructions of the block
+};
+
+// Followed by num_instructions CodeOps.
+struct AnalysisCacheHeader
+{
+	u32 next_address;
+	u32 broken;
+	BlockStats stats;
+	BlockRegStats gpa;
+	BlockRegStats fpa;
+};
+#pragma pack(pop)
+
+class AnalysisCache : public LinearDiskCacheReader<AnalysisCacheKey, u8>
+{
+	struct Entry
+	{
+		AnalysisCacheKey key;
+		std::vector<u8> data;
+	};
+
+	// Usually there's only one entry per address, more if the game loads
+	// different code there.
+	std::unordered_map<u32, std::vector<Entry>> m_entries;
+	LinearDiskCache<AnalysisCacheKey, u8> m_disk_cache;
+	std::vector<u32> m_words;
+
+	u64 HashInstructions(u32 address, u32 num_instructions)
+	{
+		m_words.resize(num_instructions);
+		for (u32 i = 0; i < num_instructions; ++i)
+			m_words[i] = JitInterface::Read_Opcode_JIT(address + i * 4);
+		return GetMurmurHash3((const u8*)m_words.data(), num_instructions * 4, 0);
+	}
+
+public:
+	void Open(const std::string& filename)
+	{
+		u32 count = m_disk_cache.OpenAndRead(filename, *this);
+		INFO_LOG(DYNA_REC, "Loaded %u cached block analyses from %s", count, filename.c_str());
+	}
+
+	~AnalysisCache()
+	{
+		m_disk_cache.Sync();
+		m_disk_cache.Close();
+	}
+
+	void Read(const AnalysisCacheKey &key, const u8 *value, u32 value_size) override
+	{
+		if (value_size != sizeof(AnalysisCacheHeader) + key.num_instructions * sizeof(CodeOp))
+			return;
+		Entry entry;
+		entry.key = key;
+		entry.data.assign(value, value + value_size);
+		m_entries[key.address].push_back(std::move(entry));
+	}
+
+	bool Lookup(u32 address, u32 block_size, u32 options, CodeBlock *block, CodeOp *code, u32 *next_address)
+	{
+		auto it = m_entries.find(address);
+		if (it == m_entries.end())
+			return false;
+
+		for (const Entry& entry : it->second)
+		{
+			const AnalysisCacheKey& key = entry.key;
+			if (key.block_size != block_size || key.options != options ||
+			    key.hash != HashInstructions(address, key.num_instructions))
+				continue;
+
+			AnalysisCacheHeader header;
+			memcpy(&header, entry.data.data(), sizeof(header));
+			memcpy(code, entry.data.data() + sizeof(header), key.num_instructions * sizeof(CodeOp));
+			for (u32 i = 0; i < key.num_instructions; ++i)
+				code[i].opinfo = GetOpInfo(code[i].inst);
+
+			*block->m_stats = header.stats;
+			*block->m_gpa = header.gpa;
+			*block->m_fpa = header.fpa;
+			block->m_num_instructions = key.num_instructions;
+			block->m_broken = header.broken != 0;
+			*next_address = header.next_address;
+			return true;
+		}
+		return false;
+	}
+
+	void Insert(u32 block_size, u32 options, const CodeBlock &block, const CodeOp *code, u32 next_address)
+	{
+		AnalysisCacheKey key;
+		key.address = block.m_address;
+		key.block_size = block_size;
+		key.options = options;
+		key.num_instructions = block.m_num_instructions;
+		key.hash = HashInstructions(block.m_address, block.m_num_instructions);
+
+		AnalysisCacheHeader header;
+		header.next_address = next_address;
+		header.broken = block.m_broken;
+		header.stats = *block.m_stats;
+		header.gpa = *block.m_gpa;
+		header.fpa = *block.m_fpa;
+
+		Entry entry;
+		entry.key = key;
+		entry.data.resize(sizeof(header) + key.num_instructions * sizeof(CodeOp));
+		memcpy(entry.data.data(), &header, sizeof(header));
+		CodeOp* ops = (CodeOp*)(entry.data.data() + sizeof(header));
+		memcpy(ops, code, key.num_instructions * sizeof(CodeOp));
+		// Pointers don't survive a restart.
+		for (u32 i = 0; i < key.num_instructions; ++i)
+			ops[i].opinfo = nullptr;
+
+		m_disk_cache.Append(key, entry.data.data(), (u32)entry.data.size());
+		m_entries[key.address].push_back(std::move(entry));
+	}
+};
+
+PPCAnalyzer::PPCAnalyzer() : m_options(0)
+{
+}
+
+PPCAnalyzer::~PPCAnalyzer()
+{
+}
+
+void PPCAnalyzer::OpenCache(const std::string& filename)
+{
+	m_cache.reset(new AnalysisCache);
+	m_cache->Open(filename);
+}
+
+void PPCAnalyzer::CloseCache()
+{
+	m_cache.reset();
+}
+
+// Returns the number of instructions of the function at address, including
+// its blr, if it can be inlined at a call site, or 0 if it can't.
+static u32 GetInlinableFunctionSize(u32 address)
+{
+	const auto& symbols = g_symbolDB.Symbols();
+	auto it = symbols.find(address);
+	if (it == symbols.end())
+		return 0;
+
+	const Symbol& func = it->second;
+	if (func.type != Symbol::SYMBOL_FUNCTION || (func.flags & (FFLAG_LEAF | FFLAG_STRAIGHT)) != (FFLAG_LEAF | FFLAG_STRAIGHT))
+		return 0;
+	u32 size = func.size / 4;
+	if (size == 0 || size > INLINE_FUNCTION_MAX_SIZE || HLE::GetFunctionIndex(address) != 0)
+		return 0;
+
+	// The symbol may come from a map file, or the code may have been
+	// replaced since it was analyzed: check that it still runs straight
+	// through to a blr, without touching LR.
+	for (u32 i = 0; i < size - 1; ++i)
+	{
+		UGeckoInstruction inst = JitInterface::Read_Opcode_JIT(address + i * 4);
+		if (inst.hex == 0)
+			return 0;
+		const GekkoOPInfo* opinfo = GetOpInfo(inst);
+		if (!opinfo || (opinfo->flags & FL_ENDBLOCK))
+			return 0;
+		if (inst.OPCD == 31 && inst.SUBOP10 == 467 && ((inst.SPRU << 5) | (inst.SPRL & 0x1F)) == SPR_LR)
+			return 0;
+	}
+	if (JitInterface::Read_Opcode_JIT(address + (size - 1) * 4) != 0x4e800020)
+		return 0;
+	return size;
+}
+
 u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32 blockSize)
 {
 	// Clear block stats
@@ -543,6 +730,7 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 	block->m_broken = false;
 	block->m_memory_exception = false;
 	block->m_num_instructions = 0;
+	block->m_inlined_functions.clear();
 
 	if (address == 0)
 	{
@@ -563,7 +751,14 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 
 	CodeOp *code = buffer->codebuffer;
 
+	u32 next_address;
+	if (m_cache && m_cache->Lookup(address, blockSize, m_options, block, code, &next_address))
+		return next_address;
+
 	bool found_exit = false;
+	bool cacheable = true;
+	// The blr of the function being inlined, and where it returns to.
+	u32 inline_blr = 0;
 	u32 return_address = 0;
 	u32 numFollows = 0;
 	u32 num_inst = 0;
@@ -588,55 +783,42 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 
 			SetInstructionStats(block, &code[i], opinfo, i);
 
+			if (return_address != 0 && address == inline_blr)
+			{
+				// The return of an inlined function: the block goes on after the bl,
+				// which has already set LR.
+				code[i].skip = true;
+				address = return_address;
+				return_address = 0;
+				continue;
+			}
+
 			bool follow = false;
 			u32 destination = 0;
 
 			bool conditional_continue = false;
 
 			// Do we inline leaf functions?
-			if (HasOption(OPTION_LEAF_INLINE))
+			// TODO: Find the optimal value for FUNCTION_FOLLOWING_THRESHOLD.
+			//       If it is small, the performance will be down.
+			//       If it is big, the size of generated code will be big and
+			//       cache clearning will happen many times.
+			if (HasOption(OPTION_LEAF_INLINE) && inst.OPCD == 18 && inst.LK && blockSize > 1 &&
+			    numFollows < FUNCTION_FOLLOWING_THRESHOLD)
 			{
-				if (inst.OPCD == 18 && blockSize > 1)
-				{
-					//Is bx - should we inline? yes!
-					if (inst.AA)
-						destination = SignExt26(inst.LI << 2);
-					else
-						destination = address + SignExt26(inst.LI << 2);
-					if (destination != block->m_address)
-						follow = true;
-				}
-				else if (inst.OPCD == 19 && inst.SUBOP10 == 16 &&
-					(inst.BO & (1 << 4)) && (inst.BO & (1 << 2)) &&
-					return_address != 0)
-				{
-					// bclrx with unconditional branch = return
-					follow = true;
-					destination = return_address;
-					return_address = 0;
+				if (inst.AA)
+					destination = SignExt26(inst.LI << 2);
+				else
+					destination = address + SignExt26(inst.LI << 2);
 
-					if (inst.LK)
-						return_address = address + 4;
-				}
-				else if (inst.OPCD == 31 && inst.SUBOP10 == 467)
+				u32 size = GetInlinableFunctionSize(destination);
+				if (size != 0)
 				{
-					// mtspr
-					const u32 index = (inst.SPRU << 5) | (inst.SPRL & 0x1F);
-					if (index == SPR_LR) {
-						// We give up to follow the return address
-						// because we have to check the register usage.
-						return_address = 0;
-					}
+					follow = true;
+					inline_blr = destination + (size - 1) * 4;
+					return_address = address + 4;
+					block->m_inlined_functions.push_back(std::make_pair(destination, size));
 				}
-
-				// TODO: Find the optimal value for FUNCTION_FOLLOWING_THRESHOLD.
-				//       If it is small, the performance will be down.
-				//       If it is big, the size of generated code will be big and
-				//       cache clearning will happen many times.
-				// TODO: Investivate the reason why
-				//       "0" is fastest in some games, MP2 for example.
-				if (numFollows > FUNCTION_FOLLOWING_THRESHOLD)
-					follow = false;
 			}
 
 			if (HasOption(OPTION_CONDITIONAL_CONTINUE))
@@ -677,8 +859,6 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 				}
 				address += 4;
 			}
-			// XXX: We don't support inlining yet.
-#if 0
 			else
 			{
 				numFollows++;
@@ -686,14 +866,13 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 				// because bx may store a certain value to the link register.
 				// Instead, we skip a part of bx in Jit**::bx().
 				address = destination;
-				merged_addresses[size_of_merged_addresses++] = address;
 			}
-#endif
 		}
 		else
 		{
 			// ISI exception or other critical memory exception occured (game over)
 			ERROR_LOG(DYNA_REC, "Instruction hex was 0!");
+			cacheable = false;
 			break;
 		}
 	}
@@ -729,6 +908,14 @@ u32 PPCAnalyzer::Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32
 		code[i].wantsCR1 = wantsCR1;
 		code[i].wantsPS1 = wantsPS1;
 	}
+
+	// The cache checks the instructions of a block as one range.
+	if (numFollows > 0)
+		cacheable = false;
+
+	if (m_cache && cacheable && block->m_num_instructions > 0)
+		m_cache->Insert(blockSize, m_options, *block, code, address);
+
 	return address;
 }
 
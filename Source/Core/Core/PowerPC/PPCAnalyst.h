@@ -7,7 +7,9 @@
 #include <algorithm>
 #include <cstdlib>
 #include <map>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "Common/Common.h"
@@ -127,8 +129,15 @@ struct CodeBlock
 
 	// Did we have a memory_exception?
 	bool m_memory_exception;
+
+	// Functions compiled into the block at their call sites,
+	// as (address, number of instructions) pairs.
+	std::vector<std::pair<u32, u32>> m_inlined_functions;
 };
 
+// Keeps the results of PPCAnalyzer::Analyze, in memory and on disk.
+class AnalysisCache;
+
 class PPCAnalyzer
 {
 private:
@@ -138,6 +147,8 @@ private:
 
 	// Options
 	u32 m_options;
+
+	std::unique_ptr<AnalysisCache> m_cache;
 public:
 
 	enum AnalystOption
@@ -148,10 +159,10 @@ public:
 		// Requires JIT support to be enabled.
 		OPTION_CONDITIONAL_CONTINUE = (1 << 0),
 
-		// If there is a unconditional branch that jumps to a leaf function then inline it.
-		// Might require JIT intervention to support it correctly.
-		// Requires JITBLock support for inlined code
-		// XXX: NOT COMPLETE
+		// If there is a bl to a small leaf function known to g_symbolDB that
+		// runs straight through to its blr, then inline it.
+		// The JIT must set LR for a bl that isn't the last instruction, skip
+		// the blr, and invalidate the block when the function's code changes.
 		OPTION_LEAF_INLINE = (1 << 1),
 
 		// Complex blocks support jumping backwards on to themselves.
@@ -168,13 +179,20 @@ public:
 	};
 
 
-	PPCAnalyzer() : m_options(0) {}
+	PPCAnalyzer();
+	~PPCAnalyzer();
 
 	// Option setting/getting
 	void SetOption(AnalystOption option) { m_options |= option; }
 	void ClearOption(AnalystOption option) { m_options &= ~(option); }
 	bool HasOption(AnalystOption option) { return !!(m_options & option); }
 
+	// Reuses the analysis of blocks whose instructions are unchanged since they
+	// were stored in filename, and appends new results to it.
+	// Must not be used with the MMU, as blocks are looked up by address.
+	void OpenCache(const std::string& filename);
+	void CloseCache();
+
 	u32 Analyze(u32 address, CodeBlock *block, CodeBuffer *buffer, u32 blockSize);
 };
 
@@ -141,3 +141,37 @@ void cInterfaceGLX::Shutdown()
 	}
 }
 
+cInterfaceBase* cInterfaceGLX::CreateSharedContext()
+{
+	GLXContext shared_ctx = glXCreateContext(dpy, vi, ctx, GL_TRUE);
+	if (!shared_ctx)
+	{
+		ERROR_LOG(VIDEO, "Unable to create shared GLX context.");
+		return nullptr;
+	}
+	return new cInterfaceGLXShared(dpy, win, shared_ctx);
+}
+
+void* cInterfaceGLXShared::GetFuncAddress(const std::string& name)
+{
+	return (void*)glXGetProcAddress((const GLubyte*)name.c_str());
+}
+
+bool cInterfaceGLXShared::MakeCurrent()
+{
+	return glXMakeCurrent(dpy, win, ctx);
+}
+
+bool cInterfaceGLXShared::ClearCurrent()
+{
+	return glXMakeCurrent(dpy, None, nullptr);
+}
+
+void cInterfaceGLXShared::Shutdown()
+{
+	if (ctx)
+	{
+		glXDestroyContext(dpy, ctx);
+		ctx = nullptr;
+	}
+}
@@ -27,4 +27,20 @@ public:
 	bool MakeCurrent() override;
 	bool ClearCurrent() override;
 	void Shutdown() override;
+	cInterfaceBase* CreateSharedContext() override;
+};
+
+// A context sharing objects with the main one, current on the main window from another thread.
+class cInterfaceGLXShared : public cInterfaceBase
+{
+private:
+	Display *dpy;
+	Window win;
+	GLXContext ctx;
+public:
+	cInterfaceGLXShared(Display *_dpy, Window _win, GLXContext _ctx) : dpy(_dpy), win(_win), ctx(_ctx) {}
+	void* GetFuncAddress(const std::string& name) override;
+	bool MakeCurrent() override;
+	bool ClearCurrent() override;
+	void Shutdown() override;
 };
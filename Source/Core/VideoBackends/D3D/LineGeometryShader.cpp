@@ -171,7 +171,7 @@ bool LineGeometryShader::SetShader(u32 components, float lineWidth,
 		// Generate new shader. Warning: not thread-safe.
 		static char buffer[16384];
 		ShaderCode code;
-		code.SetBuffer(buffer);
+		code.SetBuffer(buffer, sizeof(buffer));
 		GenerateVSOutputStructForGS(code, API_D3D);
 		code.Write("\n%s", LINE_GS_COMMON);
 
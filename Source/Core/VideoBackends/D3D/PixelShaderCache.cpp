@@ -407,7 +407,9 @@ class PixelShaderCacheInserter : public LinearDiskCacheReader<PixelShaderUid, u8
 public:
 	void Read(const PixelShaderUid &key, const u8 *value, u32 value_size)
 	{
-		PixelShaderCache::InsertByteCode(key, value, value_size);
+		PixelShaderUid uid = key;
+		uid.CalculateHash();
+		PixelShaderCache::InsertByteCode(uid, value, value_size);
 	}
 };
 
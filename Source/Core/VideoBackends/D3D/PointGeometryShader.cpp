@@ -165,7 +165,7 @@ bool PointGeometryShader::SetShader(u32 components, float pointSize,
 		// Generate new shader. Warning: not thread-safe.
 		static char buffer[16384];
 		ShaderCode code;
-		code.SetBuffer(buffer);
+		code.SetBuffer(buffer, sizeof(buffer));
 		GenerateVSOutputStructForGS(code, API_D3D);
 		code.Write("\n%s", POINT_GS_COMMON);
 
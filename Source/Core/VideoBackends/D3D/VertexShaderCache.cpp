@@ -62,8 +62,10 @@ class VertexShaderCacheInserter : public LinearDiskCacheReader<VertexShaderUid,
 public:
 	void Read(const VertexShaderUid &key, const u8 *value, u32 value_size)
 	{
+		VertexShaderUid uid = key;
+		uid.CalculateHash();
 		D3DBlob* blob = new D3DBlob(value_size, value);
-		VertexShaderCache::InsertByteCode(key, blob);
+		VertexShaderCache::InsertByteCode(uid, blob);
 		blob->Release();
 
 	}
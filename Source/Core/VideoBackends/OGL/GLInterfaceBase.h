@@ -24,6 +24,7 @@ protected:
 
 	u32 s_opengl_mode;
 public:
+	virtual ~cInterfaceBase() {}
 	virtual void Swap() {}
 	virtual void SetMode(u32 mode) { s_opengl_mode = GLInterfaceMode::MODE_OPENGL; }
 	virtual u32 GetMode() { return s_opengl_mode; }
@@ -33,6 +34,10 @@ public:
 	virtual bool ClearCurrent() { return true; }
 	virtual void Shutdown() {}
 
+	// Creates a context sharing its objects with this one, to be made current on another thread.
+	// Returns nullptr if this isn't supported. The caller deletes it after calling Shutdown.
+	virtual cInterfaceBase* CreateSharedContext() { return nullptr; }
+
 	virtual void SwapInterval(int Interval) { }
 	virtual u32 GetBackBufferWidth() { return s_backbuffer_width; }
 	virtual u32 GetBackBufferHeight() { return s_backbuffer_height; }
@@ -2,11 +2,16 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <atomic>
 #include <string>
 
+#include "Common/Event.h"
+#include "Common/FifoQueue.h"
 #include "Common/MathUtil.h"
 #include "Common/StringUtil.h"
+#include "Common/Thread.h"
 
+#include "VideoBackends/OGL/GLInterfaceBase.h"
 #include "VideoBackends/OGL/ProgramShaderCache.h"
 #include "VideoBackends/OGL/Render.h"
 #include "VideoBackends/OGL/StreamBuffer.h"
@@ -27,7 +32,7 @@ u32 ProgramShaderCache::s_ubo_buffer_size;
 s32 ProgramShaderCache::s_ubo_align;
 
 static StreamBuffer *s_buffer;
-static int num_failures = 0;
+static std::atomic<int> num_failures(0);
 
 static LinearDiskCache<SHADERUID, u8> g_program_disk_cache;
 static GLuint CurrentProgram = 0;
@@ -39,6 +44,27 @@ UidChecker<VertexShaderUid,VertexShaderCode> ProgramShaderCache::vertex_uid_chec
 
 static char s_glsl_header[1024] = "";
 
+// Background shader compiling: programs are compiled and linked on a separate
+// thread, in a context sharing its objects with the video thread's one.
+struct CompileRequest
+{
+	SHADERUID uid;
+	std::string vcode, pcode;
+};
+
+struct CompileResult
+{
+	SHADERUID uid;
+	GLuint glprogid;
+};
+
+static cInterfaceBase* s_compile_context;
+static std::thread s_compile_thread;
+static std::atomic<bool> s_compile_thread_running;
+static Common::Event s_compile_event;
+static Common::FifoQueue<CompileRequest, false> s_compile_requests;
+static Common::FifoQueue<CompileResult, false> s_compile_results;
+
 static std::string GetGLSLVersionString()
 {
 	GLSL_VERSION v = g_ogl_config.eSupportedGLSLVersion;
@@ -161,6 +187,9 @@ GLuint ProgramShaderCache::GetCurrentProgram()
 
 SHADER* ProgramShaderCache::SetShader(DSTALPHA_MODE dstAlphaMode, u32 components)
 {
+	if (s_compile_context)
+		RetrieveCompiledShaders();
+
 	SHADERUID uid;
 	GetShaderId(&uid, dstAlphaMode, components);
 
@@ -169,6 +198,9 @@ SHADER* ProgramShaderCache::SetShader(DSTALPHA_MODE dstAlphaMode, u32 components
 	{
 		if (uid == last_uid)
 		{
+			if (last_entry->pending)
+				return nullptr;
+
 			GFX_DEBUGGER_PAUSE_AT(NEXT_PIXEL_SHADER_CHANGE, true);
 			last_entry->shader.Bind();
 			return &last_entry->shader;
@@ -184,6 +216,9 @@ SHADER* ProgramShaderCache::SetShader(DSTALPHA_MODE dstAlphaMode, u32 components
 		PCacheEntry *entry = &iter->second;
 		last_entry = entry;
 
+		if (last_entry->pending)
+			return nullptr;
+
 		GFX_DEBUGGER_PAUSE_AT(NEXT_PIXEL_SHADER_CHANGE, true);
 		last_entry->shader.Bind();
 		return &last_entry->shader;
@@ -193,6 +228,7 @@ SHADER* ProgramShaderCache::SetShader(DSTALPHA_MODE dstAlphaMode, u32 components
 	PCacheEntry& newentry = pshaders[uid];
 	last_entry = &newentry;
 	newentry.in_cache = 0;
+	newentry.pending = false;
 
 	VertexShaderCode vcode;
 	PixelShaderCode pcode;
@@ -217,6 +253,21 @@ SHADER* ProgramShaderCache::SetShader(DSTALPHA_MODE dstAlphaMode, u32 components
 	}
 #endif
 
+	if (s_compile_context)
+	{
+		CompileRequest request;
+		request.uid = uid;
+		request.vcode = vcode.GetBuffer();
+		request.pcode = pcode.GetBuffer();
+		s_compile_requests.Push(std::move(request));
+		s_compile_event.Set();
+
+		newentry.pending = true;
+		INCSTAT(stats.numPixelShadersCreated);
+		SETSTAT(stats.numPixelShadersAlive, pshaders.size());
+		return nullptr;
+	}
+
 	if (!CompileShader(newentry.shader, vcode.GetBuffer(), pcode.GetBuffer()))
 	{
 		GFX_DEBUGGER_PAUSE_AT(NEXT_ERROR, true);
@@ -232,6 +283,18 @@ SHADER* ProgramShaderCache::SetShader(DSTALPHA_MODE dstAlphaMode, u32 components
 }
 
 bool ProgramShaderCache::CompileShader(SHADER& shader, const char* vcode, const char* pcode)
+{
+	if (!LinkShader(shader, vcode, pcode))
+		return false;
+
+	shader.SetProgramVariables();
+
+	return true;
+}
+
+// Everything of CompileShader but SetProgramVariables, which may bind the
+// program and thus has to happen on the video thread.
+bool ProgramShaderCache::LinkShader(SHADER& shader, const char* vcode, const char* pcode)
 {
 	GLuint vsid = CompileSingleShader(GL_VERTEX_SHADER, vcode);
 	GLuint psid = CompileSingleShader(GL_FRAGMENT_SHADER, pcode);
@@ -295,14 +358,73 @@ bool ProgramShaderCache::CompileShader(SHADER& shader, const char* vcode, const
 
 		// Don't try to use this shader
 		glDeleteProgram(pid);
+		shader.glprogid = 0;
 		return false;
 	}
 
-	shader.SetProgramVariables();
-
 	return true;
 }
 
+void ProgramShaderCache::CompileThread()
+{
+	Common::SetCurrentThreadName("Shader compiler");
+	s_compile_context->MakeCurrent();
+
+	while (true)
+	{
+		s_compile_event.Wait();
+		if (!s_compile_thread_running)
+			break;
+
+		CompileRequest request;
+		while (s_compile_thread_running && s_compile_requests.Pop(request))
+		{
+			SHADER shader;
+			LinkShader(shader, request.vcode.c_str(), request.pcode.c_str());
+
+			// Make sure the program is complete before the video thread uses it
+			glFinish();
+
+			CompileResult result;
+			result.uid = request.uid;
+			result.glprogid = shader.glprogid;
+			s_compile_results.Push(result);
+		}
+	}
+
+	s_compile_context->ClearCurrent();
+}
+
+void ProgramShaderCache::RetrieveCompiledShaders()
+{
+	CompileResult result;
+	while (s_compile_results.Pop(result))
+	{
+		PCacheEntry& entry = pshaders[result.uid];
+		entry.pending = false;
+		entry.shader.glprogid = result.glprogid;
+		if (result.glprogid)
+			entry.shader.SetProgramVariables();
+	}
+}
+
+void ProgramShaderCache::StopCompileThread()
+{
+	if (!s_compile_context)
+		return;
+
+	s_compile_thread_running = false;
+	s_compile_event.Set();
+	s_compile_thread.join();
+
+	RetrieveCompiledShaders();
+	s_compile_requests.Clear();
+
+	s_compile_context->Shutdown();
+	delete s_compile_context;
+	s_compile_context = nullptr;
+}
+
 GLuint ProgramShaderCache::CompileSingleShader(GLuint type, const char* code)
 {
 	GLuint result = glCreateShader(type);
@@ -425,16 +547,33 @@ void ProgramShaderCache::Init()
 
 	CurrentProgram = 0;
 	last_entry = nullptr;
+
+	// Shader debugging wants the source of each program, which is only kept for synchronous compiles
+	if (g_ActiveConfig.bBackgroundShaderCompiling && !g_ActiveConfig.bEnableShaderDebugging)
+	{
+		s_compile_context = GLInterface->CreateSharedContext();
+		if (s_compile_context)
+		{
+			s_compile_thread_running = true;
+			s_compile_thread = std::thread(CompileThread);
+		}
+		else
+		{
+			WARN_LOG(VIDEO, "Background shader compiling isn't supported on this platform.");
+		}
+	}
 }
 
 void ProgramShaderCache::Shutdown()
 {
+	StopCompileThread();
+
 	// store all shaders in cache on disk
 	if (g_ogl_config.bSupportsGLSLCache && !g_Config.bEnableShaderDebugging)
 	{
 		for (auto& entry : pshaders)
 		{
-			if (entry.second.in_cache)
+			if (entry.second.in_cache || !entry.second.shader.glprogid)
 			{
 				continue;
 			}
@@ -528,12 +667,16 @@ void ProgramShaderCache::CreateHeader()
 
 void ProgramShaderCache::ProgramShaderCacheInserter::Read(const SHADERUID& key, const u8* value, u32 value_size)
 {
+	SHADERUID uid = key;
+	uid.CalculateHash();
+
 	const u8 *binary = value+sizeof(GLenum);
 	GLenum *prog_format = (GLenum*)value;
 	GLint binary_size = value_size-sizeof(GLenum);
 
 	PCacheEntry entry;
 	entry.in_cache = 1;
+	entry.pending = false;
 	entry.shader.glprogid = glCreateProgram();
 	glProgramBinary(entry.shader.glprogid, *prog_format, binary, binary_size);
 
@@ -542,7 +685,7 @@ void ProgramShaderCache::ProgramShaderCacheInserter::Read(const SHADERUID& key,
 
 	if (success)
 	{
-		pshaders[key] = entry;
+		pshaders[uid] = entry;
 		entry.shader.SetProgramVariables();
 	}
 	else
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <unordered_map>
+
 #include "Common/LinearDiskCache.h"
 #include "Core/ConfigManager.h"
 #include "VideoBackends/OGL/GLUtil.h"
@@ -41,6 +43,20 @@ public:
 	{
 		return puid == r.puid && vuid == r.vuid;
 	}
+
+	void CalculateHash()
+	{
+		vuid.CalculateHash();
+		puid.CalculateHash();
+	}
+
+	struct Hasher
+	{
+		size_t operator()(const SHADERUID& uid) const
+		{
+			return (size_t)(uid.puid.GetHash() ^ (uid.vuid.GetHash() * 0x9E3779B97F4A7C15ull));
+		}
+	};
 };
 
 
@@ -69,6 +85,7 @@ public:
 	{
 		SHADER shader;
 		bool in_cache;
+		bool pending; // still being compiled by the background thread
 
 		void Destroy()
 		{
@@ -76,11 +93,14 @@ public:
 		}
 	};
 
-	typedef std::map<SHADERUID, PCacheEntry> PCache;
+	typedef std::unordered_map<SHADERUID, PCacheEntry, SHADERUID::Hasher> PCache;
 
 	static PCacheEntry GetShaderProgram();
 	static GLuint GetCurrentProgram();
+	// Returns nullptr if the shader can't be used for drawing, e.g. because it's still being compiled.
 	static SHADER* SetShader(DSTALPHA_MODE dstAlphaMode, u32 components);
+	// True if the shader SetShader last looked up is still being compiled in the background
+	static bool IsShaderPending() { return last_entry && last_entry->pending; }
 	static void GetShaderId(SHADERUID *uid, DSTALPHA_MODE dstAlphaMode, u32 components);
 
 	static bool CompileShader(SHADER &shader, const char* vcode, const char* pcode);
@@ -92,6 +112,11 @@ public:
 	static void CreateHeader();
 
 private:
+	static bool LinkShader(SHADER &shader, const char* vcode, const char* pcode);
+	static void CompileThread();
+	static void RetrieveCompiledShaders();
+	static void StopCompileThread();
+
 	class ProgramShaderCacheInserter : public LinearDiskCacheReader<SHADERUID, u8>
 	{
 	public:
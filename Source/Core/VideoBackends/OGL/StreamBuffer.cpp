@@ -2,6 +2,8 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <chrono>
+
 #include "Common/MemoryUtil.h"
 
 #include "VideoBackends/OGL/GLUtil.h"
@@ -10,6 +12,7 @@
 
 #include "VideoCommon/DriverDetails.h"
 #include "VideoCommon/OnScreenDisplay.h"
+#include "VideoCommon/Statistics.h"
 
 namespace OGL
 {
@@ -57,6 +60,8 @@ StreamBuffer::~StreamBuffer()
  * Some here, new fences for the chunks between m_used_iterator and m_iterator (also update m_used_iterator).
  *
  * As ring buffers have an ugly behavoir on rollover, have fun to read this code ;)
+ *
+ * Waiting on a fence the gpu hasn't passed yet is a stall of the cpu; these are counted in the statistics.
  */
 
 void StreamBuffer::CreateFences()
@@ -77,6 +82,20 @@ void StreamBuffer::DeleteFences()
 		glDeleteSync(fences[i]);
 	}
 }
+void StreamBuffer::WaitForFence(int slot)
+{
+	if (glClientWaitSync(fences[slot], GL_SYNC_FLUSH_COMMANDS_BIT, 0) == GL_TIMEOUT_EXPIRED)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		glClientWaitSync(fences[slot], 0, GL_TIMEOUT_IGNORED);
+		auto end = std::chrono::high_resolution_clock::now();
+
+		INCSTAT(stats.thisFrame.numStreamBufferStalls);
+		ADDSTAT(stats.thisFrame.usStreamBufferStalled, std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+	}
+	glDeleteSync(fences[slot]);
+}
+
 void StreamBuffer::AllocMemory(u32 size)
 {
 	// insert waiting slots for used memory
@@ -89,8 +108,7 @@ void StreamBuffer::AllocMemory(u32 size)
 	// wait for new slots to end of buffer
 	for (int i = SLOT(m_free_iterator) + 1; i <= SLOT(m_iterator + size) && i < SYNC_POINTS; i++)
 	{
-		glClientWaitSync(fences[i], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
-		glDeleteSync(fences[i]);
+		WaitForFence(i);
 	}
 	m_free_iterator = m_iterator + size;
 
@@ -109,8 +127,7 @@ void StreamBuffer::AllocMemory(u32 size)
 		// wait for space at the start
 		for (int i = 0; i <= SLOT(m_iterator + size); i++)
 		{
-			glClientWaitSync(fences[i], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
-			glDeleteSync(fences[i]);
+			WaitForFence(i);
 		}
 		m_free_iterator = m_iterator + size;
 	}
@@ -199,7 +216,8 @@ public:
  * And is usually not available on OpenGL3 gpus.
  *
  * ARB_buffer_storage allows us to render from a mapped buffer.
- * So we map it persistently in the initialization.
+ * So we map it persistently and coherently in the initialization,
+ * which makes an upload nothing more than a memcpy.
  *
  * Unsync mapping sounds like an easy task, but it isn't for threaded drivers.
  * So every mapping on current close-source driver _will_ end in
@@ -216,12 +234,11 @@ public:
 		glBindBuffer(m_buffertype, m_buffer);
 
 		// PERSISTANT_BIT to make sure that the buffer can be used while mapped
-		// COHERENT_BIT is set so we don't have to use a MemoryBarrier on write
-		// CLIENT_STORAGE_BIT is set since we access the buffer more frequently on the client side then server side
+		// COHERENT_BIT is set so we don't have to flush the written ranges or use a MemoryBarrier
 		glBufferStorage(m_buffertype, m_size, nullptr,
-			GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT);
+			GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
 		m_pointer = (u8*)glMapBufferRange(m_buffertype, 0, m_size,
-			GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_FLUSH_EXPLICIT_BIT);
+			GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
 	}
 
 	~BufferStorage()
@@ -239,7 +256,6 @@ public:
 
 	void Unmap(u32 used_size) override
 	{
-		glFlushMappedBufferRange(m_buffertype, m_iterator, used_size);
 		m_iterator += used_size;
 	}
 
@@ -371,16 +387,16 @@ StreamBuffer* StreamBuffer::Create(u32 type, u32 size)
 	// Prefer the syncing buffers over the orphaning one
 	if (g_ogl_config.bSupportsGLSync)
 	{
-		// pinned memory is much faster than buffer storage on amd cards
-		if (g_ogl_config.bSupportsGLPinnedMemory &&
-			!(DriverDetails::HasBug(DriverDetails::BUG_BROKENPINNEDMEMORY) && type == GL_ELEMENT_ARRAY_BUFFER))
-			return new PinnedMemory(type, size);
-
-		// buffer storage works well in most situations
+		// A persistently mapped ring buffer is the way to go, the others are only fallbacks for older drivers
 		if (g_ogl_config.bSupportsGLBufferStorage &&
 			!(DriverDetails::HasBug(DriverDetails::BUG_BROKENBUFFERSTORAGE) && type == GL_ARRAY_BUFFER))
 			return new BufferStorage(type, size);
 
+		// pinned memory works the same way, but is AMD only
+		if (g_ogl_config.bSupportsGLPinnedMemory &&
+			!(DriverDetails::HasBug(DriverDetails::BUG_BROKENPINNEDMEMORY) && type == GL_ELEMENT_ARRAY_BUFFER))
+			return new PinnedMemory(type, size);
+
 		// don't fall back to MapAnd* for nvidia drivers
 		if (DriverDetails::HasBug(DriverDetails::BUG_BROKENUNSYNCMAPPING))
 			return new BufferSubData(type, size);
@@ -147,13 +147,14 @@ void VertexManager::vFlush(bool useDstAlpha)
 
 	// If host supports GL_ARB_blend_func_extended, we can do dst alpha in
 	// the same pass as regular rendering.
+	SHADER* shader;
 	if (useDstAlpha && dualSourcePossible)
 	{
-		ProgramShaderCache::SetShader(DSTALPHA_DUAL_SOURCE_BLEND, nativeVertexFmt->m_components);
+		shader = ProgramShaderCache::SetShader(DSTALPHA_DUAL_SOURCE_BLEND, nativeVertexFmt->m_components);
 	}
 	else
 	{
-		ProgramShaderCache::SetShader(DSTALPHA_NONE, nativeVertexFmt->m_components);
+		shader = ProgramShaderCache::SetShader(DSTALPHA_NONE, nativeVertexFmt->m_components);
 	}
 
 	// upload global constants
@@ -163,19 +164,26 @@ void VertexManager::vFlush(bool useDstAlpha)
 	nativeVertexFmt->SetupVertexPointers();
 	GL_REPORT_ERRORD();
 
-	Draw(stride);
+	// With background shader compiling, draws are skipped until their shader is ready
+	if (shader || !ProgramShaderCache::IsShaderPending())
+		Draw(stride);
+	else
+		INCSTAT(stats.thisFrame.numDrawCallsSkipped);
 
 	// run through vertex groups again to set alpha
 	if (useDstAlpha && !dualSourcePossible)
 	{
-		ProgramShaderCache::SetShader(DSTALPHA_ALPHA_PASS, nativeVertexFmt->m_components);
+		shader = ProgramShaderCache::SetShader(DSTALPHA_ALPHA_PASS, nativeVertexFmt->m_components);
 
 		// only update alpha
 		glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_TRUE);
 
 		glDisable(GL_BLEND);
 
-		Draw(stride);
+		if (shader || !ProgramShaderCache::IsShaderPending())
+			Draw(stride);
+		else
+			INCSTAT(stats.thisFrame.numDrawCallsSkipped);
 
 		// restore color mask
 		g_renderer->SetColorMask();
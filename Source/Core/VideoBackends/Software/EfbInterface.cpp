@@ -19,6 +19,7 @@ static u8 efb[EFB_WIDTH*EFB_HEIGHT*6];
 namespace EfbInterface
 {
 	u32 perf_values[PQ_NUM_MEMBERS];
+	static u32 perf_quad_remainder[PQ_NUM_MEMBERS];
 
 	static inline u32 GetColorOffset(u16 x, u16 y)
 	{
@@ -35,6 +36,27 @@ namespace EfbInterface
 		p.DoArray(efb, EFB_WIDTH*EFB_HEIGHT*6);
 	}
 
+	void IncPerfCounterQuadCount(PerfQueryType type, u32 pixels)
+	{
+		u32 quads = perf_quad_remainder[type] + pixels;
+		perf_quad_remainder[type] = quads % 3;
+		perf_values[type] += quads / 3;
+	}
+
+	// Pixels are 24 bits, so reading or writing them as u32 would touch the next
+	// pixel too, which may be drawn by another rasterizer thread.
+	static inline u32 Read24(u32 offset)
+	{
+		return efb[offset] | (efb[offset + 1] << 8) | (efb[offset + 2] << 16);
+	}
+
+	static inline void Write24(u32 offset, u32 val)
+	{
+		efb[offset] = (u8)val;
+		efb[offset + 1] = (u8)(val >> 8);
+		efb[offset + 2] = (u8)(val >> 16);
+	}
+
 	static void SetPixelAlphaOnly(u32 offset, u8 a)
 	{
 		switch (bpmem.zcontrol.pixel_format)
@@ -47,10 +69,9 @@ namespace EfbInterface
 		case PEControl::RGBA6_Z24:
 			{
 				u32 a32 = a;
-				u32 *dst = (u32*)&efb[offset];
-				u32 val = *dst & 0xffffffc0;
+				u32 val = Read24(offset) & 0xffffc0;
 				val |= (a32 >> 2) & 0x0000003f;
-				*dst = val;
+				Write24(offset, val);
 			}
 			break;
 		default:
@@ -66,31 +87,24 @@ namespace EfbInterface
 		case PEControl::Z24:
 			{
 				u32 src = *(u32*)rgb;
-				u32 *dst = (u32*)&efb[offset];
-				u32 val = *dst & 0xff000000;
-				val |= src >> 8;
-				*dst = val;
+				Write24(offset, src >> 8);
 			}
 			break;
 		case PEControl::RGBA6_Z24:
 			{
 				u32 src = *(u32*)rgb;
-				u32 *dst = (u32*)&efb[offset];
-				u32 val = *dst & 0xff00003f;
+				u32 val = Read24(offset) & 0x00003f;
 				val |= (src >> 4) & 0x00000fc0; // blue
 				val |= (src >> 6) & 0x0003f000; // green
 				val |= (src >> 8) & 0x00fc0000; // red
-				*dst = val;
+				Write24(offset, val);
 			}
 			break;
 		case PEControl::RGB565_Z16:
 			{
 				INFO_LOG(VIDEO, "RGB565_Z16 is not supported correctly yet");
 				u32 src = *(u32*)rgb;
-				u32 *dst = (u32*)&efb[offset];
-				u32 val = *dst & 0xff000000;
-				val |= src >> 8;
-				*dst = val;
+				Write24(offset, src >> 8);
 			}
 			break;
 		default:
@@ -106,32 +120,24 @@ namespace EfbInterface
 		case PEControl::Z24:
 			{
 				u32 src = *(u32*)color;
-				u32 *dst = (u32*)&efb[offset];
-				u32 val = *dst & 0xff000000;
-				val |= src >> 8;
-				*dst = val;
+				Write24(offset, src >> 8);
 			}
 			break;
 		case PEControl::RGBA6_Z24:
 			{
 				u32 src = *(u32*)color;
-				u32 *dst = (u32*)&efb[offset];
-				u32 val = *dst & 0xff000000;
-				val |= (src >> 2) & 0x0000003f; // alpha
+				u32 val = (src >> 2) & 0x0000003f; // alpha
 				val |= (src >> 4) & 0x00000fc0; // blue
 				val |= (src >> 6) & 0x0003f000; // green
 				val |= (src >> 8) & 0x00fc0000; // red
-				*dst = val;
+				Write24(offset, val);
 			}
 			break;
 		case PEControl::RGB565_Z16:
 			{
 				INFO_LOG(VIDEO, "RGB565_Z16 is not supported correctly yet");
 				u32 src = *(u32*)color;
-				u32 *dst = (u32*)&efb[offset];
-				u32 val = *dst & 0xff000000;
-				val |= src >> 8;
-				*dst = val;
+				Write24(offset, src >> 8);
 			}
 			break;
 		default:
@@ -146,15 +152,15 @@ namespace EfbInterface
 		case PEControl::RGB8_Z24:
 		case PEControl::Z24:
 			{
-				u32 src = *(u32*)&efb[offset];
+				u32 src = Read24(offset);
 				u32 *dst = (u32*)color;
-				u32 val = 0xff | ((src & 0x00ffffff) << 8);
+				u32 val = 0xff | (src << 8);
 				*dst = val;
 			}
 			break;
 		case PEControl::RGBA6_Z24:
 			{
-				u32 src = *(u32*)&efb[offset];
+				u32 src = Read24(offset);
 				color[ALP_C] = Convert6To8(src & 0x3f);
 				color[BLU_C] = Convert6To8((src >> 6) & 0x3f);
 				color[GRN_C] = Convert6To8((src >> 12) & 0x3f);
@@ -164,9 +170,9 @@ namespace EfbInterface
 		case PEControl::RGB565_Z16:
 			{
 				INFO_LOG(VIDEO, "RGB565_Z16 is not supported correctly yet");
-				u32 src = *(u32*)&efb[offset];
+				u32 src = Read24(offset);
 				u32 *dst = (u32*)color;
-				u32 val = 0xff | ((src & 0x00ffffff) << 8);
+				u32 val = 0xff | (src << 8);
 				*dst = val;
 			}
 			break;
@@ -182,21 +188,11 @@ namespace EfbInterface
 		case PEControl::RGB8_Z24:
 		case PEControl::RGBA6_Z24:
 		case PEControl::Z24:
-			{
-				u32 *dst = (u32*)&efb[offset];
-				u32 val = *dst & 0xff000000;
-				val |= depth & 0x00ffffff;
-				*dst = val;
-			}
+			Write24(offset, depth);
 			break;
 		case PEControl::RGB565_Z16:
-			{
-				INFO_LOG(VIDEO, "RGB565_Z16 is not supported correctly yet");
-				u32 *dst = (u32*)&efb[offset];
-				u32 val = *dst & 0xff000000;
-				val |= depth & 0x00ffffff;
-				*dst = val;
-			}
+			INFO_LOG(VIDEO, "RGB565_Z16 is not supported correctly yet");
+			Write24(offset, depth);
 			break;
 		default:
 			ERROR_LOG(VIDEO, "Unsupported pixel format: %i", static_cast<int>(bpmem.zcontrol.pixel_format));
@@ -212,15 +208,11 @@ namespace EfbInterface
 		case PEControl::RGB8_Z24:
 		case PEControl::RGBA6_Z24:
 		case PEControl::Z24:
-			{
-				depth = (*(u32*)&efb[offset]) & 0x00ffffff;
-			}
+			depth = Read24(offset);
 			break;
 		case PEControl::RGB565_Z16:
-			{
-				INFO_LOG(VIDEO, "RGB565_Z16 is not supported correctly yet");
-				depth = (*(u32*)&efb[offset]) & 0x00ffffff;
-			}
+			INFO_LOG(VIDEO, "RGB565_Z16 is not supported correctly yet");
+			depth = Read24(offset);
 			break;
 		default:
 			ERROR_LOG(VIDEO, "Unsupported pixel format: %i", static_cast<int>(bpmem.zcontrol.pixel_format));
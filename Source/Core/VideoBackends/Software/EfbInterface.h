@@ -61,16 +61,11 @@ namespace EfbInterface
 	void DoState(PointerWrap &p);
 
 	extern u32 perf_values[PQ_NUM_MEMBERS];
-	inline void IncPerfCounterQuadCount(PerfQueryType type)
-	{
-		// NOTE: hardware doesn't process individual pixels but quads instead.
-		// Current software renderer architecture works on pixels though, so
-		// we have this "quad" hack here to only increment the registers on
-		// every fourth rendered pixel
-		static u32 quad[PQ_NUM_MEMBERS];
-		if (++quad[type] != 3)
-			return;
-		quad[type] = 0;
-		++perf_values[type];
-	}
+	// NOTE: hardware doesn't process individual pixels but quads instead.
+	// Current software renderer architecture works on pixels though, so
+	// we have this "quad" hack here to only increment the registers on
+	// every fourth rendered pixel.
+	// The rasterizer threads count the pixels themselves and add them here
+	// once they are done.
+	void IncPerfCounterQuadCount(PerfQueryType type, u32 pixels);
 }
@@ -3,6 +3,12 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <memory>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "Common/Common.h"
 #include "VideoBackends/Software/BPMemLoader.h"
@@ -33,49 +39,94 @@ static inline s32 FixedLog2(float f)
 
 namespace Rasterizer
 {
-static Slope ZSlope;
-static Slope WSlope;
-static Slope ColorSlopes[2][4];
-static Slope TexSlopes[8][3];
+// The EFB is split in tiles. Triangles are set up in order and queued in the
+// bins of the tiles they overlap, then each tile is drawn by a single thread.
+// This keeps the order in which a pixel is drawn to, and so the output doesn't
+// depend on the number of threads.
+#define TILE_SIZE 32
 
-static s32 vertex0X;
-static s32 vertex0Y;
-static float vertexOffsetX;
-static float vertexOffsetY;
+static const int NUM_TILES_X = (EFB_WIDTH + TILE_SIZE - 1) / TILE_SIZE;
+static const int NUM_TILES_Y = (EFB_HEIGHT + TILE_SIZE - 1) / TILE_SIZE;
+
+// Flushed earlier if a primitive has that many triangles
+static const size_t MAX_QUEUED_TRIANGLES = 4096;
+
+struct Triangle
+{
+	Slope ZSlope;
+	Slope WSlope;
+	Slope ColorSlopes[2][4];
+	Slope TexSlopes[8][3];
+
+	s32 vertex0X;
+	s32 vertex0Y;
+	float vertexOffsetX;
+	float vertexOffsetY;
+
+	// Bounding rectangle, scissored
+	s32 minx, maxx, miny, maxy;
+
+	// Half-edge constants and deltas
+	s32 C1, C2, C3;
+	s32 DX12, DX23, DX31;
+	s32 DY12, DY23, DY31;
+};
+
+// The state of a rasterizer thread
+struct RasterContext
+{
+	Tev tev;
+	RasterBlock rasterBlock;
+	u32 rasterizedPixels;
+};
+
+static Slope ZSlope;
 
 static s32 scissorLeft = 0;
 static s32 scissorTop = 0;
 static s32 scissorRight = 0;
 static s32 scissorBottom = 0;
 
-static Tev tev;
-static RasterBlock rasterBlock;
+static std::vector<Triangle> s_triangles;
+static std::vector<u32> s_bins[NUM_TILES_X * NUM_TILES_Y];
+static std::vector<int> s_binned_tiles;
+
+// The Tevs point into themselves, so they must not be moved around
+static std::unique_ptr<RasterContext[]> s_contexts;
+static int s_num_contexts;
 
 void DoState(PointerWrap &p)
 {
 	ZSlope.DoState(p);
-	WSlope.DoState(p);
-	for (auto& color_slopes_1d : ColorSlopes)
-		for (Slope& color_slope : color_slopes_1d)
-			color_slope.DoState(p);
-	for (auto& tex_slopes_1d : TexSlopes)
-		for (Slope& tex_slope : tex_slopes_1d)
-			tex_slope.DoState(p);
-	p.Do(vertex0X);
-	p.Do(vertex0Y);
-	p.Do(vertexOffsetX);
-	p.Do(vertexOffsetY);
 	p.Do(scissorLeft);
 	p.Do(scissorTop);
 	p.Do(scissorRight);
 	p.Do(scissorBottom);
-	tev.DoState(p);
-	p.Do(rasterBlock);
+	// The registers loaded through BP are shared by all the Tevs. The rest of
+	// a Tev's state is either set up by Init or written for every pixel before
+	// it's drawn, so the first Tev's state stands for all of them.
+	s_contexts[0].tev.DoState(p);
 }
 
 void Init()
 {
-	tev.Init();
+#ifdef _OPENMP
+	s_num_contexts = std::max<int>(omp_get_num_procs(), g_SWVideoConfig.rasterizerThreads);
+#else
+	s_num_contexts = 1;
+#endif
+	s_contexts.reset(new RasterContext[s_num_contexts]);
+	for (int i = 0; i < s_num_contexts; ++i)
+	{
+		s_contexts[i].tev.Init();
+		s_contexts[i].rasterizedPixels = 0;
+	}
+
+	s_triangles.clear();
+	s_triangles.reserve(MAX_QUEUED_TRIANGLES);
+	for (auto& bin : s_bins)
+		bin.clear();
+	s_binned_tiles.clear();
 
 	// Set initial z reference plane in the unlikely case that zfreeze is enabled when drawing the first primitive.
 	// TODO: This is just a guess!
@@ -116,33 +167,36 @@ void SetScissor()
 
 void SetTevReg(int reg, int comp, bool konst, s16 color)
 {
-	tev.SetRegColor(reg, comp, konst, color);
+	Tev::SetRegColor(reg, comp, konst, color);
 }
 
-inline void Draw(s32 x, s32 y, s32 xi, s32 yi)
+static inline void Draw(const Triangle& tri, RasterContext& ctx, s32 x, s32 y, s32 xi, s32 yi)
 {
-	INCSTAT(swstats.thisFrame.rasterizedPixels);
+	INCSTAT(ctx.rasterizedPixels);
+
+	Tev& tev = ctx.tev;
 
-	float dx = vertexOffsetX + (float)(x - vertex0X);
-	float dy = vertexOffsetY + (float)(y - vertex0Y);
+	float dx = tri.vertexOffsetX + (float)(x - tri.vertex0X);
+	float dy = tri.vertexOffsetY + (float)(y - tri.vertex0Y);
 
-	s32 z = (s32)ZSlope.GetValue(dx, dy);
+	s32 z = (s32)tri.ZSlope.GetValue(dx, dy);
 	if (z < 0 || z > 0x00ffffff)
 		return;
 
 	if (bpmem.UseEarlyDepthTest() && g_SWVideoConfig.bZComploc)
 	{
 		// TODO: Test if perf regs are incremented even if test is disabled
-		EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_INPUT_ZCOMPLOC);
+		tev.PerfPixels[PQ_ZCOMP_INPUT_ZCOMPLOC]++;
 		if (bpmem.zmode.testenable)
 		{
 			// early z
 			if (!EfbInterface::ZCompare(x, y, z))
 				return;
 		}
-		EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_OUTPUT_ZCOMPLOC);
+		tev.PerfPixels[PQ_ZCOMP_OUTPUT_ZCOMPLOC]++;
 	}
 
+	RasterBlock& rasterBlock = ctx.rasterBlock;
 	RasterBlockPixel& pixel = rasterBlock.Pixel[xi][yi];
 
 	tev.Position[0] = x;
@@ -154,7 +208,7 @@ inline void Draw(s32 x, s32 y, s32 xi, s32 yi)
 	{
 		for (int comp = 0; comp < 4; comp++)
 		{
-			u16 color = (u16)ColorSlopes[i][comp].GetValue(dx, dy);
+			u16 color = (u16)tri.ColorSlopes[i][comp].GetValue(dx, dy);
 
 			// clamp color value to 0
 			u16 mask = ~(color >> 8);
@@ -186,16 +240,16 @@ inline void Draw(s32 x, s32 y, s32 xi, s32 yi)
 	tev.Draw();
 }
 
-static void InitTriangle(float X1, float Y1, s32 xi, s32 yi)
+static void InitTriangle(Triangle* tri, float X1, float Y1, s32 xi, s32 yi)
 {
-	vertex0X = xi;
-	vertex0Y = yi;
+	tri->vertex0X = xi;
+	tri->vertex0Y = yi;
 
 	// adjust a little less than 0.5
 	const float adjust = 0.495f;
 
-	vertexOffsetX = ((float)xi - X1) + adjust;
-	vertexOffsetY = ((float)yi - Y1) + adjust;
+	tri->vertexOffsetX = ((float)xi - X1) + adjust;
+	tri->vertexOffsetY = ((float)yi - Y1) + adjust;
 }
 
 static void InitSlope(Slope *slope, float f1, float f2, float f3, float DX31, float DX12, float DY12, float DY31)
@@ -210,7 +264,7 @@ static void InitSlope(Slope *slope, float f1, float f2, float f3, float DX31, fl
 	slope->f0 = f1;
 }
 
-static inline void CalculateLOD(s32 &lod, bool &linear, u32 texmap, u32 texcoord)
+static inline void CalculateLOD(const RasterBlock& rasterBlock, s32 &lod, bool &linear, u32 texmap, u32 texcoord)
 {
 	FourTexUnits& texUnit = bpmem.tex[(texmap >> 2) & 1];
 	u8 subTexmap = texmap & 3;
@@ -223,17 +277,17 @@ static inline void CalculateLOD(s32 &lod, bool &linear, u32 texmap, u32 texcoord
 	float sDelta, tDelta;
 	if (tm0.diag_lod)
 	{
-		float *uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
-		float *uv1 = rasterBlock.Pixel[1][1].Uv[texcoord];
+		const float *uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
+		const float *uv1 = rasterBlock.Pixel[1][1].Uv[texcoord];
 
 		sDelta = fabsf(uv0[0] - uv1[0]);
 		tDelta = fabsf(uv0[1] - uv1[1]);
 	}
 	else
 	{
-		float *uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
-		float *uv1 = rasterBlock.Pixel[1][0].Uv[texcoord];
-		float *uv2 = rasterBlock.Pixel[0][1].Uv[texcoord];
+		const float *uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
+		const float *uv1 = rasterBlock.Pixel[1][0].Uv[texcoord];
+		const float *uv2 = rasterBlock.Pixel[0][1].Uv[texcoord];
 
 		sDelta = std::max(fabsf(uv0[0] - uv1[0]), fabsf(uv0[0] - uv2[0]));
 		tDelta = std::max(fabsf(uv0[1] - uv1[1]), fabsf(uv0[1] - uv2[1]));
@@ -256,7 +310,7 @@ static inline void CalculateLOD(s32 &lod, bool &linear, u32 texmap, u32 texcoord
 	lod = CLAMP(lod, (s32)tm1.min_lod, (s32)tm1.max_lod);
 }
 
-static void BuildBlock(s32 blockX, s32 blockY)
+static void BuildBlock(const Triangle& tri, RasterBlock& rasterBlock, s32 blockX, s32 blockY)
 {
 	for (s32 yi = 0; yi < BLOCK_SIZE; yi++)
 	{
@@ -264,10 +318,10 @@ static void BuildBlock(s32 blockX, s32 blockY)
 		{
 			RasterBlockPixel& pixel = rasterBlock.Pixel[xi][yi];
 
-			float dx = vertexOffsetX + (float)(xi + blockX - vertex0X);
-			float dy = vertexOffsetY + (float)(yi + blockY - vertex0Y);
+			float dx = tri.vertexOffsetX + (float)(xi + blockX - tri.vertex0X);
+			float dy = tri.vertexOffsetY + (float)(yi + blockY - tri.vertex0Y);
 
-			float invW = 1.0f / WSlope.GetValue(dx, dy);
+			float invW = 1.0f / tri.WSlope.GetValue(dx, dy);
 			pixel.InvW = invW;
 
 			// tex coords
@@ -276,13 +330,13 @@ static void BuildBlock(s32 blockX, s32 blockY)
 				float projection = invW;
 				if (xfmem.texMtxInfo[i].projection)
 				{
-					float q = TexSlopes[i][2].GetValue(dx, dy) * invW;
+					float q = tri.TexSlopes[i][2].GetValue(dx, dy) * invW;
 					if (q != 0.0f)
 						projection = invW / q;
 				}
 
-				pixel.Uv[i][0] = TexSlopes[i][0].GetValue(dx, dy) * projection;
-				pixel.Uv[i][1] = TexSlopes[i][1].GetValue(dx, dy) * projection;
+				pixel.Uv[i][0] = tri.TexSlopes[i][0].GetValue(dx, dy) * projection;
+				pixel.Uv[i][1] = tri.TexSlopes[i][1].GetValue(dx, dy) * projection;
 			}
 		}
 	}
@@ -295,7 +349,7 @@ static void BuildBlock(s32 blockX, s32 blockY)
 		u32 texcoord = indref & 3;
 		indref >>= 3;
 
-		CalculateLOD(rasterBlock.IndirectLod[i], rasterBlock.IndirectLinear[i], texmap, texcoord);
+		CalculateLOD(rasterBlock, rasterBlock.IndirectLod[i], rasterBlock.IndirectLinear[i], texmap, texcoord);
 	}
 
 	for (unsigned int i = 0; i <= bpmem.genMode.numtevstages; i++)
@@ -307,11 +361,178 @@ static void BuildBlock(s32 blockX, s32 blockY)
 			u32 texmap = order.getTexMap(stageOdd);
 			u32 texcoord = order.getTexCoord(stageOdd);
 
-			CalculateLOD(rasterBlock.TextureLod[i], rasterBlock.TextureLinear[i], texmap, texcoord);
+			CalculateLOD(rasterBlock, rasterBlock.TextureLod[i], rasterBlock.TextureLinear[i], texmap, texcoord);
 		}
 	}
 }
 
+// Draws the blocks of a triangle that are in the given tile
+static void DrawTriangleInTile(const Triangle& tri, RasterContext& ctx, s32 tileX, s32 tileY)
+{
+	const s32 C1 = tri.C1, C2 = tri.C2, C3 = tri.C3;
+	const s32 DX12 = tri.DX12, DX23 = tri.DX23, DX31 = tri.DX31;
+	const s32 DY12 = tri.DY12, DY23 = tri.DY23, DY31 = tri.DY31;
+
+	// Fixed-pos32 deltas
+	const s32 FDX12 = DX12 << 4;
+	const s32 FDX23 = DX23 << 4;
+	const s32 FDX31 = DX31 << 4;
+
+	const s32 FDY12 = DY12 << 4;
+	const s32 FDY23 = DY23 << 4;
+	const s32 FDY31 = DY31 << 4;
+
+	// Tiles are made of whole blocks, so this doesn't move the blocks
+	const s32 minx = std::max(tri.minx, tileX);
+	const s32 maxx = std::min(tri.maxx, tileX + TILE_SIZE);
+	const s32 miny = std::max(tri.miny, tileY);
+	const s32 maxy = std::min(tri.maxy, tileY + TILE_SIZE);
+
+	// Loop through blocks
+	for (s32 y = miny; y < maxy; y += BLOCK_SIZE)
+	{
+		for (s32 x = minx; x < maxx; x += BLOCK_SIZE)
+		{
+			// Corners of block
+			s32 x0 = x << 4;
+			s32 x1 = (x + BLOCK_SIZE - 1) << 4;
+			s32 y0 = y << 4;
+			s32 y1 = (y + BLOCK_SIZE - 1) << 4;
+
+			// Evaluate half-space functions
+			bool a00 = C1 + DX12 * y0 - DY12 * x0 > 0;
+			bool a10 = C1 + DX12 * y0 - DY12 * x1 > 0;
+			bool a01 = C1 + DX12 * y1 - DY12 * x0 > 0;
+			bool a11 = C1 + DX12 * y1 - DY12 * x1 > 0;
+			int a = (a00 << 0) | (a10 << 1) | (a01 << 2) | (a11 << 3);
+
+			bool b00 = C2 + DX23 * y0 - DY23 * x0 > 0;
+			bool b10 = C2 + DX23 * y0 - DY23 * x1 > 0;
+			bool b01 = C2 + DX23 * y1 - DY23 * x0 > 0;
+			bool b11 = C2 + DX23 * y1 - DY23 * x1 > 0;
+			int b = (b00 << 0) | (b10 << 1) | (b01 << 2) | (b11 << 3);
+
+			bool c00 = C3 + DX31 * y0 - DY31 * x0 > 0;
+			bool c10 = C3 + DX31 * y0 - DY31 * x1 > 0;
+			bool c01 = C3 + DX31 * y1 - DY31 * x0 > 0;
+			bool c11 = C3 + DX31 * y1 - DY31 * x1 > 0;
+			int c = (c00 << 0) | (c10 << 1) | (c01 << 2) | (c11 << 3);
+
+			// Skip block when outside an edge
+			if (a == 0x0 || b == 0x0 || c == 0x0)
+				continue;
+
+			BuildBlock(tri, ctx.rasterBlock, x, y);
+
+			// Accept whole block when totally covered
+			if (a == 0xF && b == 0xF && c == 0xF)
+			{
+				for (s32 iy = 0; iy < BLOCK_SIZE; iy++)
+				{
+					for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
+					{
+						Draw(tri, ctx, x + ix, y + iy, ix, iy);
+					}
+				}
+			}
+			else // Partially covered block
+			{
+				s32 CY1 = C1 + DX12 * y0 - DY12 * x0;
+				s32 CY2 = C2 + DX23 * y0 - DY23 * x0;
+				s32 CY3 = C3 + DX31 * y0 - DY31 * x0;
+
+				for (s32 iy = 0; iy < BLOCK_SIZE; iy++)
+				{
+					s32 CX1 = CY1;
+					s32 CX2 = CY2;
+					s32 CX3 = CY3;
+
+					for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
+					{
+						if (CX1 > 0 && CX2 > 0 && CX3 > 0)
+						{
+							Draw(tri, ctx, x + ix, y + iy, ix, iy);
+						}
+
+						CX1 -= FDY12;
+						CX2 -= FDY23;
+						CX3 -= FDY31;
+					}
+
+					CY1 += FDX12;
+					CY2 += FDX23;
+					CY3 += FDX31;
+				}
+			}
+		}
+	}
+}
+
+static int GetNumThreads()
+{
+	// The TEV dumps go through buffers shared by all pixels
+	if (g_SWVideoConfig.bDumpTevStages || g_SWVideoConfig.bDumpTevTextureFetches)
+		return 1;
+
+#ifdef _OPENMP
+	int threads = g_SWVideoConfig.rasterizerThreads ? (int)g_SWVideoConfig.rasterizerThreads : omp_get_num_procs();
+	return std::min(threads, s_num_contexts);
+#else
+	return 1;
+#endif
+}
+
+void Flush()
+{
+	if (s_triangles.empty())
+		return;
+
+	const int num_threads = GetNumThreads();
+	const int num_tiles = (int)s_binned_tiles.size();
+
+	Tev::SetupStages();
+
+	#pragma omp parallel for schedule(dynamic) num_threads(num_threads) if (num_threads > 1 && num_tiles > 1)
+	for (int i = 0; i < num_tiles; ++i)
+	{
+#ifdef _OPENMP
+		RasterContext& ctx = s_contexts[omp_get_thread_num()];
+#else
+		RasterContext& ctx = s_contexts[0];
+#endif
+		const int tile = s_binned_tiles[i];
+		const s32 tileX = (tile % NUM_TILES_X) * TILE_SIZE;
+		const s32 tileY = (tile / NUM_TILES_X) * TILE_SIZE;
+
+		for (u32 triangle : s_bins[tile])
+			DrawTriangleInTile(s_triangles[triangle], ctx, tileX, tileY);
+		s_bins[tile].clear();
+	}
+
+	for (int i = 0; i < num_threads; ++i)
+	{
+		RasterContext& ctx = s_contexts[i];
+		Tev& tev = ctx.tev;
+
+		ADDSTAT(swstats.thisFrame.rasterizedPixels, ctx.rasterizedPixels);
+		ADDSTAT(swstats.thisFrame.tevPixelsIn, tev.PixelsIn);
+		ADDSTAT(swstats.thisFrame.tevPixelsOut, tev.PixelsOut);
+		ctx.rasterizedPixels = 0;
+		tev.PixelsIn = 0;
+		tev.PixelsOut = 0;
+
+		for (int type = 0; type < PQ_NUM_MEMBERS; ++type)
+		{
+			if (tev.PerfPixels[type])
+				EfbInterface::IncPerfCounterQuadCount((PerfQueryType)type, tev.PerfPixels[type]);
+			tev.PerfPixels[type] = 0;
+		}
+	}
+
+	s_triangles.clear();
+	s_binned_tiles.clear();
+}
+
 void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVertexData *v2)
 {
 	INCSTAT(swstats.thisFrame.numTrianglesDrawn);
@@ -343,15 +564,6 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 	const s32 DY23 = Y2 - Y3;
 	const s32 DY31 = Y3 - Y1;
 
-	// Fixed-pos32 deltas
-	const s32 FDX12 = DX12 << 4;
-	const s32 FDX23 = DX23 << 4;
-	const s32 FDX31 = DX31 << 4;
-
-	const s32 FDY12 = DY12 << 4;
-	const s32 FDY23 = DY23 << 4;
-	const s32 FDY31 = DY31 << 4;
-
 	// Bounding rectangle
 	s32 minx = (std::min(std::min(X1, X2), X3) + 0xF) >> 4;
 	s32 maxx = (std::max(std::max(X1, X2), X3) + 0xF) >> 4;
@@ -367,6 +579,9 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 	if (minx >= maxx || miny >= maxy)
 		return;
 
+	s_triangles.emplace_back();
+	Triangle& tri = s_triangles.back();
+
 	// Setup slopes
 	float fltx1 = v0->screenPosition.x;
 	float flty1 = v0->screenPosition.y;
@@ -375,10 +590,10 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 	float fltdy12 = flty1 - v1->screenPosition.y;
 	float fltdy31 = v2->screenPosition.y - flty1;
 
-	InitTriangle(fltx1, flty1, (X1 + 0xF) >> 4, (Y1 + 0xF) >> 4);
+	InitTriangle(&tri, fltx1, flty1, (X1 + 0xF) >> 4, (Y1 + 0xF) >> 4);
 
 	float w[3] = { 1.0f / v0->projectedPosition.w, 1.0f / v1->projectedPosition.w, 1.0f / v2->projectedPosition.w };
-	InitSlope(&WSlope, w[0], w[1], w[2], fltdx31, fltdx12, fltdy12, fltdy31);
+	InitSlope(&tri.WSlope, w[0], w[1], w[2], fltdx31, fltdx12, fltdy12, fltdy31);
 
 	// TODO: The zfreeze emulation is not quite correct, yet!
 	// Many things might prevent us from reaching this line (culling, clipping, scissoring).
@@ -386,23 +601,29 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 	// We're currently sloppy at this since we abort early if any of the culling/clipping/scissoring tests fail.
 	if (!bpmem.genMode.zfreeze || !g_SWVideoConfig.bZFreeze)
 		InitSlope(&ZSlope, v0->screenPosition[2], v1->screenPosition[2], v2->screenPosition[2], fltdx31, fltdx12, fltdy12, fltdy31);
+	tri.ZSlope = ZSlope;
 
 	for (unsigned int i = 0; i < bpmem.genMode.numcolchans; i++)
 	{
 		for (int comp = 0; comp < 4; comp++)
-			InitSlope(&ColorSlopes[i][comp], v0->color[i][comp], v1->color[i][comp], v2->color[i][comp], fltdx31, fltdx12, fltdy12, fltdy31);
+			InitSlope(&tri.ColorSlopes[i][comp], v0->color[i][comp], v1->color[i][comp], v2->color[i][comp], fltdx31, fltdx12, fltdy12, fltdy31);
 	}
 
 	for (unsigned int i = 0; i < bpmem.genMode.numtexgens; i++)
 	{
 		for (int comp = 0; comp < 3; comp++)
-			InitSlope(&TexSlopes[i][comp], v0->texCoords[i][comp] * w[0], v1->texCoords[i][comp] * w[1], v2->texCoords[i][comp] * w[2], fltdx31, fltdx12, fltdy12, fltdy31);
+			InitSlope(&tri.TexSlopes[i][comp], v0->texCoords[i][comp] * w[0], v1->texCoords[i][comp] * w[1], v2->texCoords[i][comp] * w[2], fltdx31, fltdx12, fltdy12, fltdy31);
 	}
 
 	// Start in corner of 8x8 block
 	minx &= ~(BLOCK_SIZE - 1);
 	miny &= ~(BLOCK_SIZE - 1);
 
+	tri.minx = minx;
+	tri.maxx = maxx;
+	tri.miny = miny;
+	tri.maxy = maxy;
+
 	// Half-edge constants
 	s32 C1 = DY12 * X1 - DX12 * Y1;
 	s32 C2 = DY23 * X2 - DX23 * Y2;
@@ -413,84 +634,31 @@ void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVer
 	if (DY23 < 0 || (DY23 == 0 && DX23 > 0)) C2++;
 	if (DY31 < 0 || (DY31 == 0 && DX31 > 0)) C3++;
 
-	// Loop through blocks
-	for (s32 y = miny; y < maxy; y += BLOCK_SIZE)
+	tri.C1 = C1;
+	tri.C2 = C2;
+	tri.C3 = C3;
+	tri.DX12 = DX12;
+	tri.DX23 = DX23;
+	tri.DX31 = DX31;
+	tri.DY12 = DY12;
+	tri.DY23 = DY23;
+	tri.DY31 = DY31;
+
+	// Queue the triangle in the bins of the tiles its blocks start in
+	const u32 index = (u32)(s_triangles.size() - 1);
+	for (s32 ty = miny / TILE_SIZE; ty <= (maxy - 1) / TILE_SIZE; ty++)
 	{
-		for (s32 x = minx; x < maxx; x += BLOCK_SIZE)
+		for (s32 tx = minx / TILE_SIZE; tx <= (maxx - 1) / TILE_SIZE; tx++)
 		{
-			// Corners of block
-			s32 x0 = x << 4;
-			s32 x1 = (x + BLOCK_SIZE - 1) << 4;
-			s32 y0 = y << 4;
-			s32 y1 = (y + BLOCK_SIZE - 1) << 4;
-
-			// Evaluate half-space functions
-			bool a00 = C1 + DX12 * y0 - DY12 * x0 > 0;
-			bool a10 = C1 + DX12 * y0 - DY12 * x1 > 0;
-			bool a01 = C1 + DX12 * y1 - DY12 * x0 > 0;
-			bool a11 = C1 + DX12 * y1 - DY12 * x1 > 0;
-			int a = (a00 << 0) | (a10 << 1) | (a01 << 2) | (a11 << 3);
-
-			bool b00 = C2 + DX23 * y0 - DY23 * x0 > 0;
-			bool b10 = C2 + DX23 * y0 - DY23 * x1 > 0;
-			bool b01 = C2 + DX23 * y1 - DY23 * x0 > 0;
-			bool b11 = C2 + DX23 * y1 - DY23 * x1 > 0;
-			int b = (b00 << 0) | (b10 << 1) | (b01 << 2) | (b11 << 3);
-
-			bool c00 = C3 + DX31 * y0 - DY31 * x0 > 0;
-			bool c10 = C3 + DX31 * y0 - DY31 * x1 > 0;
-			bool c01 = C3 + DX31 * y1 - DY31 * x0 > 0;
-			bool c11 = C3 + DX31 * y1 - DY31 * x1 > 0;
-			int c = (c00 << 0) | (c10 << 1) | (c01 << 2) | (c11 << 3);
-
-			// Skip block when outside an edge
-			if (a == 0x0 || b == 0x0 || c == 0x0)
-				continue;
-
-			BuildBlock(x, y);
-
-			// Accept whole block when totally covered
-			if (a == 0xF && b == 0xF && c == 0xF)
-			{
-				for (s32 iy = 0; iy < BLOCK_SIZE; iy++)
-				{
-					for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
-					{
-						Draw(x + ix, y + iy, ix, iy);
-					}
-				}
-			}
-			else // Partially covered block
-			{
-				s32 CY1 = C1 + DX12 * y0 - DY12 * x0;
-				s32 CY2 = C2 + DX23 * y0 - DY23 * x0;
-				s32 CY3 = C3 + DX31 * y0 - DY31 * x0;
-
-				for (s32 iy = 0; iy < BLOCK_SIZE; iy++)
-				{
-					s32 CX1 = CY1;
-					s32 CX2 = CY2;
-					s32 CX3 = CY3;
-
-					for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
-					{
-						if (CX1 > 0 && CX2 > 0 && CX3 > 0)
-						{
-							Draw(x + ix, y + iy, ix, iy);
-						}
-
-						CX1 -= FDY12;
-						CX2 -= FDY23;
-						CX3 -= FDY31;
-					}
-
-					CY1 += FDX12;
-					CY2 += FDX23;
-					CY3 += FDX31;
-				}
-			}
+			std::vector<u32>& bin = s_bins[ty * NUM_TILES_X + tx];
+			if (bin.empty())
+				s_binned_tiles.push_back(ty * NUM_TILES_X + tx);
+			bin.push_back(index);
 		}
 	}
+
+	if (s_triangles.size() >= MAX_QUEUED_TRIANGLES)
+		Flush();
 }
 
 
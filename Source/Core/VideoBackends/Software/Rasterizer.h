@@ -12,8 +12,12 @@ namespace Rasterizer
 {
 	void Init();
 
+	// Sets up the triangle and queues it, it is drawn by Flush
 	void DrawTriangleFrontFace(OutputVertexData *v0, OutputVertexData *v1, OutputVertexData *v2);
 
+	// Draws the queued triangles. Must be called before the state they depend on changes.
+	void Flush();
+
 	void SetScissor();
 
 	void SetTevReg(int reg, int comp, bool konst, s16 color);
@@ -24,7 +28,7 @@ namespace Rasterizer
 		float dfdy;
 		float f0;
 
-		float GetValue(float dx, float dy) { return f0 + (dfdx * dx) + (dfdy * dy); }
+		float GetValue(float dx, float dy) const { return f0 + (dfdx * dx) + (dfdy * dy); }
 		void DoState(PointerWrap &p)
 		{
 			p.Do(dfdx);
@@ -22,6 +22,7 @@ struct SWVideoConfig : NonCopyable
 
 	bool bHwRasterizer;
 	bool bBypassXFB;
+	u32 rasterizerThreads; // 0 uses all processors
 
 	// Emulation features
 	bool bZComploc;
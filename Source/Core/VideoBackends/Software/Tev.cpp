@@ -4,6 +4,10 @@
 
 #include <cmath>
 
+#ifdef _M_X86
+#include <emmintrin.h>
+#endif
+
 #include "Common/ChunkFile.h"
 #include "Common/Common.h"
 #include "VideoBackends/Software/DebugUtil.h"
@@ -20,8 +24,75 @@
 #define ALLOW_TEV_DUMPS 0
 #endif
 
+s16 Tev::LoadedReg[4][4];
+s16 Tev::KonstantColors[4][4];
+
+#ifdef _M_X86
+// The regular color and alpha combiners of a stage, evaluated together on the
+// four ABGR components. The lanes differ in the shift, rounding and clamping,
+// so these are set up from bpmem by Tev::SetupStages.
+struct CombinerConstants
+{
+	__m128i bias;
+	__m128i shift1; // set if the scale is 2 or 4
+	__m128i shift2; // set if the scale is 4
+	__m128i half;   // set if the scale is 0.5
+	__m128i round;
+	__m128i negate_before_rounding;
+	__m128i negate_after_rounding;
+	__m128i min;    // in 16 bit lanes
+	__m128i max;
+	bool regular;
+};
+
+static CombinerConstants s_combiners[16];
+#endif
+
+void Tev::SetupStages()
+{
+#ifdef _M_X86
+	static const s32 bias_lut[4] = { 0, 128, -128, 0 };
+
+	for (unsigned int stageNum = 0; stageNum <= bpmem.genMode.numtevstages; stageNum++)
+	{
+		const TevStageCombiner::ColorCombiner& cc = bpmem.combiners[stageNum].colorC;
+		const TevStageCombiner::AlphaCombiner& ac = bpmem.combiners[stageNum].alphaC;
+		CombinerConstants& constants = s_combiners[stageNum];
+
+		constants.regular = cc.bias != 3 && ac.bias != 3;
+		if (!constants.regular)
+			continue;
+
+		// The alpha combiner rounds when the color one doesn't, and negates
+		// before shifting the result down instead of after.
+		s32 color_round = (cc.shift == 3) ? 0 : (cc.op == 1) ? 127 : 128;
+		s32 alpha_round = (ac.shift != 3) ? 0 : (ac.op == 1) ? 127 : 128;
+		s32 color_negate = cc.op ? -1 : 0;
+		s32 alpha_negate = ac.op ? -1 : 0;
+		s16 color_min = cc.clamp ? 0 : -1024, color_max = cc.clamp ? 255 : 1023;
+		s16 alpha_min = ac.clamp ? 0 : -1024, alpha_max = ac.clamp ? 255 : 1023;
+
+		constants.bias = _mm_setr_epi32(bias_lut[ac.bias], bias_lut[cc.bias], bias_lut[cc.bias], bias_lut[cc.bias]);
+		constants.shift1 = _mm_setr_epi32(
+			(ac.shift == 1 || ac.shift == 2) ? -1 : 0, (cc.shift == 1 || cc.shift == 2) ? -1 : 0,
+			(cc.shift == 1 || cc.shift == 2) ? -1 : 0, (cc.shift == 1 || cc.shift == 2) ? -1 : 0);
+		constants.shift2 = _mm_setr_epi32(ac.shift == 2 ? -1 : 0, cc.shift == 2 ? -1 : 0, cc.shift == 2 ? -1 : 0, cc.shift == 2 ? -1 : 0);
+		constants.half = _mm_setr_epi32(ac.shift == 3 ? -1 : 0, cc.shift == 3 ? -1 : 0, cc.shift == 3 ? -1 : 0, cc.shift == 3 ? -1 : 0);
+		constants.round = _mm_setr_epi32(alpha_round, color_round, color_round, color_round);
+		constants.negate_before_rounding = _mm_setr_epi32(alpha_negate, 0, 0, 0);
+		constants.negate_after_rounding = _mm_setr_epi32(0, color_negate, color_negate, color_negate);
+		constants.min = _mm_setr_epi16(alpha_min, color_min, color_min, color_min, 0, 0, 0, 0);
+		constants.max = _mm_setr_epi16(alpha_max, color_max, color_max, color_max, 0, 0, 0, 0);
+	}
+#endif
+}
+
 void Tev::Init()
 {
+	memset(PerfPixels, 0, sizeof(PerfPixels));
+	PixelsIn = 0;
+	PixelsOut = 0;
+
 	FixedConstants[0] = 0;
 	FixedConstants[1] = 32;
 	FixedConstants[2] = 64;
@@ -334,6 +405,107 @@ void Tev::DrawAlphaCompare(TevStageCombiner::AlphaCombiner& ac, const InputRegTy
 	}
 }
 
+void Tev::DrawCombiners(TevStageCombiner::ColorCombiner& cc, TevStageCombiner::AlphaCombiner& ac)
+{
+	// combine inputs
+	InputRegType inputs[4];
+	for (int i = 0; i < 3; i++)
+	{
+		inputs[BLU_C + i].a = *m_ColorInputLUT[cc.a][i];
+		inputs[BLU_C + i].b = *m_ColorInputLUT[cc.b][i];
+		inputs[BLU_C + i].c = *m_ColorInputLUT[cc.c][i];
+		inputs[BLU_C + i].d = *m_ColorInputLUT[cc.d][i];
+	}
+	inputs[ALP_C].a = *m_AlphaInputLUT[ac.a];
+	inputs[ALP_C].b = *m_AlphaInputLUT[ac.b];
+	inputs[ALP_C].c = *m_AlphaInputLUT[ac.c];
+	inputs[ALP_C].d = *m_AlphaInputLUT[ac.d];
+
+	if (cc.bias != 3)
+		DrawColorRegular(cc, inputs);
+	else
+		DrawColorCompare(cc, inputs);
+
+	if (cc.clamp)
+	{
+		Reg[cc.dest][RED_C] = Clamp255(Reg[cc.dest][RED_C]);
+		Reg[cc.dest][GRN_C] = Clamp255(Reg[cc.dest][GRN_C]);
+		Reg[cc.dest][BLU_C] = Clamp255(Reg[cc.dest][BLU_C]);
+	}
+	else
+	{
+		Reg[cc.dest][RED_C] = Clamp1024(Reg[cc.dest][RED_C]);
+		Reg[cc.dest][GRN_C] = Clamp1024(Reg[cc.dest][GRN_C]);
+		Reg[cc.dest][BLU_C] = Clamp1024(Reg[cc.dest][BLU_C]);
+	}
+
+	if (ac.bias != 3)
+		DrawAlphaRegular(ac, inputs);
+	else
+		DrawAlphaCompare(ac, inputs);
+
+	if (ac.clamp)
+		Reg[ac.dest][ALP_C] = Clamp255(Reg[ac.dest][ALP_C]);
+	else
+		Reg[ac.dest][ALP_C] = Clamp1024(Reg[ac.dest][ALP_C]);
+}
+
+#ifdef _M_X86
+void Tev::DrawCombinersSSE2(unsigned int stageNum)
+{
+	const TevStageCombiner::ColorCombiner& cc = bpmem.combiners[stageNum].colorC;
+	const TevStageCombiner::AlphaCombiner& ac = bpmem.combiners[stageNum].alphaC;
+	const CombinerConstants& constants = s_combiners[stageNum];
+
+	// Same as the scalar code, but on the ABGR lanes at once. The inputs are
+	// cut to the size of the InputRegType fields, a, b and c to unsigned 8
+	// bits and d to signed 11 bits.
+	const __m128i mask = _mm_set1_epi32(0xFF);
+	__m128i a = _mm_and_si128(mask, _mm_setr_epi32(*m_AlphaInputLUT[ac.a],
+		*m_ColorInputLUT[cc.a][BLU_INP], *m_ColorInputLUT[cc.a][GRN_INP], *m_ColorInputLUT[cc.a][RED_INP]));
+	__m128i b = _mm_and_si128(mask, _mm_setr_epi32(*m_AlphaInputLUT[ac.b],
+		*m_ColorInputLUT[cc.b][BLU_INP], *m_ColorInputLUT[cc.b][GRN_INP], *m_ColorInputLUT[cc.b][RED_INP]));
+	__m128i c = _mm_and_si128(mask, _mm_setr_epi32(*m_AlphaInputLUT[ac.c],
+		*m_ColorInputLUT[cc.c][BLU_INP], *m_ColorInputLUT[cc.c][GRN_INP], *m_ColorInputLUT[cc.c][RED_INP]));
+	__m128i d = _mm_setr_epi32(*m_AlphaInputLUT[ac.d],
+		*m_ColorInputLUT[cc.d][BLU_INP], *m_ColorInputLUT[cc.d][GRN_INP], *m_ColorInputLUT[cc.d][RED_INP]);
+	d = _mm_srai_epi32(_mm_slli_epi32(d, 21), 21);
+
+	// The products fit in 16 bits, so the upper halves of the lanes stay zero
+	c = _mm_add_epi32(c, _mm_srli_epi32(c, 7));
+	__m128i temp = _mm_add_epi32(
+		_mm_mullo_epi16(a, _mm_sub_epi32(_mm_set1_epi32(256), c)),
+		_mm_mullo_epi16(b, c));
+
+	// Scale by doubling the lanes that are scaled up
+	temp = _mm_add_epi32(temp, _mm_and_si128(temp, constants.shift1));
+	temp = _mm_add_epi32(temp, _mm_and_si128(temp, constants.shift2));
+	temp = _mm_add_epi32(temp, constants.round);
+	temp = _mm_sub_epi32(_mm_xor_si128(temp, constants.negate_before_rounding), constants.negate_before_rounding);
+	temp = _mm_srai_epi32(temp, 8);
+	temp = _mm_sub_epi32(_mm_xor_si128(temp, constants.negate_after_rounding), constants.negate_after_rounding);
+
+	__m128i result = _mm_add_epi32(d, constants.bias);
+	result = _mm_add_epi32(result, _mm_and_si128(result, constants.shift1));
+	result = _mm_add_epi32(result, _mm_and_si128(result, constants.shift2));
+	result = _mm_add_epi32(result, temp);
+	result = _mm_or_si128(_mm_and_si128(constants.half, _mm_srai_epi32(result, 1)),
+		_mm_andnot_si128(constants.half, result));
+
+	// Like the stores to Reg, keep the low 16 bits, then clamp
+	result = _mm_srai_epi32(_mm_slli_epi32(result, 16), 16);
+	result = _mm_packs_epi32(result, result);
+	result = _mm_min_epi16(_mm_max_epi16(result, constants.min), constants.max);
+
+	s16 output[8];
+	_mm_storeu_si128((__m128i*)output, result);
+	Reg[cc.dest][BLU_C] = output[BLU_C];
+	Reg[cc.dest][GRN_C] = output[GRN_C];
+	Reg[cc.dest][RED_C] = output[RED_C];
+	Reg[ac.dest][ALP_C] = output[ALP_C];
+}
+#endif
+
 static bool AlphaCompare(int alpha, int ref, AlphaTest::CompareMode comp)
 {
 	switch (comp)
@@ -508,7 +680,13 @@ void Tev::Draw()
 	_assert_(Position[0] >= 0 && Position[0] < EFB_WIDTH);
 	_assert_(Position[1] >= 0 && Position[1] < EFB_HEIGHT);
 
-	INCSTAT(swstats.thisFrame.tevPixelsIn);
+	INCSTAT(PixelsIn);
+
+	// Nothing is carried over from the previous pixel, which may have been
+	// drawn by another thread
+	memcpy(Reg, LoadedReg, sizeof(Reg));
+	memset(TexColor, 0, sizeof(TexColor));
+	memset(IndirectTex, 0, sizeof(IndirectTex));
 
 	for (unsigned int stageNum = 0; stageNum < bpmem.genMode.numindstages; stageNum++)
 	{
@@ -588,47 +766,12 @@ void Tev::Draw()
 		// set color
 		SetRasColor(order.getColorChan(stageOdd), ac.rswap * 2);
 
-		// combine inputs
-		InputRegType inputs[4];
-		for (int i = 0; i < 3; i++)
-		{
-			inputs[BLU_C + i].a = *m_ColorInputLUT[cc.a][i];
-			inputs[BLU_C + i].b = *m_ColorInputLUT[cc.b][i];
-			inputs[BLU_C + i].c = *m_ColorInputLUT[cc.c][i];
-			inputs[BLU_C + i].d = *m_ColorInputLUT[cc.d][i];
-		}
-		inputs[ALP_C].a = *m_AlphaInputLUT[ac.a];
-		inputs[ALP_C].b = *m_AlphaInputLUT[ac.b];
-		inputs[ALP_C].c = *m_AlphaInputLUT[ac.c];
-		inputs[ALP_C].d = *m_AlphaInputLUT[ac.d];
-
-		if (cc.bias != 3)
-			DrawColorRegular(cc, inputs);
+#ifdef _M_X86
+		if (s_combiners[stageNum].regular)
+			DrawCombinersSSE2(stageNum);
 		else
-			DrawColorCompare(cc, inputs);
-
-		if (cc.clamp)
-		{
-			Reg[cc.dest][RED_C] = Clamp255(Reg[cc.dest][RED_C]);
-			Reg[cc.dest][GRN_C] = Clamp255(Reg[cc.dest][GRN_C]);
-			Reg[cc.dest][BLU_C] = Clamp255(Reg[cc.dest][BLU_C]);
-		}
-		else
-		{
-			Reg[cc.dest][RED_C] = Clamp1024(Reg[cc.dest][RED_C]);
-			Reg[cc.dest][GRN_C] = Clamp1024(Reg[cc.dest][GRN_C]);
-			Reg[cc.dest][BLU_C] = Clamp1024(Reg[cc.dest][BLU_C]);
-		}
-
-		if (ac.bias != 3)
-			DrawAlphaRegular(ac, inputs);
-		else
-			DrawAlphaCompare(ac, inputs);
-
-		if (ac.clamp)
-			Reg[ac.dest][ALP_C] = Clamp255(Reg[ac.dest][ALP_C]);
-		else
-			Reg[ac.dest][ALP_C] = Clamp1024(Reg[ac.dest][ALP_C]);
+#endif
+			DrawCombiners(cc, ac);
 
 #if ALLOW_TEV_DUMPS
 		if (g_SWVideoConfig.bDumpTevStages)
@@ -757,12 +900,12 @@ void Tev::Draw()
 	if (late_ztest && bpmem.zmode.testenable)
 	{
 		// TODO: Check against hw if these values get incremented even if depth testing is disabled
-		EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_INPUT);
+		PerfPixels[PQ_ZCOMP_INPUT]++;
 
 		if (!EfbInterface::ZCompare(Position[0], Position[1], Position[2]))
 			return;
 
-		EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_OUTPUT);
+		PerfPixels[PQ_ZCOMP_OUTPUT]++;
 	}
 
 #if ALLOW_TEV_DUMPS
@@ -785,8 +928,8 @@ void Tev::Draw()
 	}
 #endif
 
-	INCSTAT(swstats.thisFrame.tevPixelsOut);
-	EfbInterface::IncPerfCounterQuadCount(PQ_BLEND_INPUT);
+	INCSTAT(PixelsOut);
+	PerfPixels[PQ_BLEND_INPUT]++;
 
 	EfbInterface::BlendTev(Position[0], Position[1], output);
 }
@@ -799,15 +942,15 @@ void Tev::SetRegColor(int reg, int comp, bool konst, s16 color)
 	}
 	else
 	{
-		Reg[reg][comp] = color;
+		LoadedReg[reg][comp] = color;
 	}
 }
 
 void Tev::DoState(PointerWrap &p)
 {
-	p.DoArray(Reg, sizeof(Reg));
+	p.DoArray(&LoadedReg[0][0], 16);
 
-	p.DoArray(KonstantColors, sizeof(KonstantColors));
+	p.DoArray(&KonstantColors[0][0], 16);
 	p.DoArray(TexColor,4);
 	p.DoArray(RasColor,4);
 	p.DoArray(StageKonst,4);
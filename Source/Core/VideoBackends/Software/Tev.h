@@ -5,6 +5,7 @@
 #pragma once
 
 #include "VideoBackends/Software/BPMemLoader.h"
+#include "VideoCommon/PerfQueryBase.h"
 
 class PointerWrap;
 
@@ -26,7 +27,11 @@ class Tev
 
 	// color order: ABGR
 	s16 Reg[4][4];
-	s16 KonstantColors[4][4];
+
+	// Loaded through BP and shared by the Tevs of all rasterizer threads.
+	// Every pixel starts with these register values.
+	static s16 LoadedReg[4][4];
+	static s16 KonstantColors[4][4];
 	s16 TexColor[4];
 	s16 RasColor[4];
 	s16 StageKonst[4];
@@ -65,6 +70,10 @@ class Tev
 	void DrawColorCompare(TevStageCombiner::ColorCombiner& cc, const InputRegType inputs[4]);
 	void DrawAlphaRegular(TevStageCombiner::AlphaCombiner& ac, const InputRegType inputs[4]);
 	void DrawAlphaCompare(TevStageCombiner::AlphaCombiner& ac, const InputRegType inputs[4]);
+	void DrawCombiners(TevStageCombiner::ColorCombiner& cc, TevStageCombiner::AlphaCombiner& ac);
+#ifdef _M_X86
+	void DrawCombinersSSE2(unsigned int stageNum);
+#endif
 
 	void Indirect(unsigned int stageNum, s32 s, s32 t);
 
@@ -77,6 +86,11 @@ public:
 	s32 TextureLod[16];
 	bool TextureLinear[16];
 
+	// Each rasterizer thread has its own Tev, which counts its pixels here
+	u32 PerfPixels[PQ_NUM_MEMBERS];
+	u32 PixelsIn;
+	u32 PixelsOut;
+
 	enum
 	{
 		ALP_C,
@@ -87,9 +101,12 @@ public:
 
 	void Init();
 
+	// Prepares what depends on the TEV stages only, before drawing with any Tev
+	static void SetupStages();
+
 	void Draw();
 
-	void SetRegColor(int reg, int comp, bool konst, s16 color);
+	static void SetRegColor(int reg, int comp, bool konst, s16 color);
 
 	void DoState(PointerWrap &p);
 };
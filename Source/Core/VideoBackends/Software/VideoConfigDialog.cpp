@@ -70,6 +70,10 @@ VideoConfigDialog::VideoConfigDialog(wxWindow* parent, const std::string& title,
 
 	// xfb
 	szr_rendering->Add(new SettingCheckBox(page_general, wxT("Bypass XFB"), wxT(""), vconfig.bBypassXFB));
+
+	// threads, 0 for all processors
+	szr_rendering->Add(new wxStaticText(page_general, wxID_ANY, wxT("Rasterizer threads:")), 1, wxALIGN_CENTER_VERTICAL, 0);
+	szr_rendering->Add(new U32Setting(page_general, wxT(""), vconfig.rasterizerThreads, 0, 64));
 	}
 
 	// - info
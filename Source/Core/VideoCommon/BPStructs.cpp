@@ -172,7 +172,9 @@ static void BPWritten(const BPCmd& bp)
 		switch (bp.newvalue & 0xFF)
 		{
 		case 0x02:
-			PixelEngine::SetFinish(); // may generate interrupt
+			// With the deterministic GPU thread, the preprocessor already did this.
+			if (!g_use_deterministic_gpu_thread)
+				PixelEngine::SetFinish(); // may generate interrupt
 			DEBUG_LOG(VIDEO, "GXSetDrawDone SetPEFinish (value: 0x%02X)", (bp.newvalue & 0xFFFF));
 			return;
 
@@ -182,11 +184,13 @@ static void BPWritten(const BPCmd& bp)
 		}
 		return;
 	case BPMEM_PE_TOKEN_ID: // Pixel Engine Token ID
-		PixelEngine::SetToken(static_cast<u16>(bp.newvalue & 0xFFFF), false);
+		if (!g_use_deterministic_gpu_thread)
+			PixelEngine::SetToken(static_cast<u16>(bp.newvalue & 0xFFFF), false);
 		DEBUG_LOG(VIDEO, "SetPEToken 0x%04x", (bp.newvalue & 0xFFFF));
 		return;
 	case BPMEM_PE_TOKEN_INT_ID: // Pixel Engine Interrupt Token ID
-		PixelEngine::SetToken(static_cast<u16>(bp.newvalue & 0xFFFF), true);
+		if (!g_use_deterministic_gpu_thread)
+			PixelEngine::SetToken(static_cast<u16>(bp.newvalue & 0xFFFF), true);
 		DEBUG_LOG(VIDEO, "SetPEToken + INT 0x%04x", (bp.newvalue & 0xFFFF));
 		return;
 
@@ -658,6 +662,47 @@ void LoadBPReg(u32 value0)
 	BPWritten(bp);
 }
 
+// Called from the FIFO preprocessor on the CPU thread with the deterministic GPU
+// thread. Handles the registers whose effects the CPU has to see in order.
+// Returns true if the GPU thread has to catch up before the CPU continues, i.e.
+// if the command writes to emulated RAM.
+bool LoadBPRegPreprocess(u32 value0)
+{
+	static u32 s_preprocess_bp_mask = 0xFFFFFF;
+
+	int regNum = value0 >> 24;
+	u32 value = value0 & s_preprocess_bp_mask;
+
+	if (regNum == BPMEM_BP_MASK)
+		s_preprocess_bp_mask = value0 & 0xFFFFFF;
+	else
+		s_preprocess_bp_mask = 0xFFFFFF;
+
+	switch (regNum)
+	{
+	case BPMEM_SETDRAWDONE:
+		if ((value & 0xFF) == 0x02)
+			PixelEngine::SetFinish();
+		break;
+	case BPMEM_PE_TOKEN_ID:
+		PixelEngine::SetToken(static_cast<u16>(value & 0xFFFF), false);
+		break;
+	case BPMEM_PE_TOKEN_INT_ID:
+		PixelEngine::SetToken(static_cast<u16>(value & 0xFFFF), true);
+		break;
+	case BPMEM_TRIGGER_EFB_COPY:
+		{
+			UPE_Copy PE_copy;
+			PE_copy.Hex = value;
+			if (PE_copy.copy_to_xfb == 0)
+				return g_ActiveConfig.EFBCopiesToRamEnabled();
+			return g_ActiveConfig.RealXFBEnabled();
+		}
+	}
+
+	return false;
+}
+
 void GetBPRegInfo(const u8* data, std::string* name, std::string* desc)
 {
 	const char* no_yes[2] = { "No", "Yes" };
@@ -8,4 +8,5 @@
 
 void BPInit();
 void LoadBPReg(u32 value0);
+bool LoadBPRegPreprocess(u32 value0);
 void BPReload();
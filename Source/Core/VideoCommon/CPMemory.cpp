@@ -16,3 +16,6 @@ TMatrixIndexB MatrixIndexB;
 TVtxDesc g_VtxDesc;
 // Most games only use the first VtxAttr and simply reconfigure it all the time as needed.
 VAT g_VtxAttr[8];
+
+// Only touched by the CPU thread, and only when the deterministic GPU thread is in use.
+CPState g_preprocess_cp_state;
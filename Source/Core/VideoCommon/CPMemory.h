@@ -247,8 +247,23 @@ struct VAT
 extern TVtxDesc g_VtxDesc;
 extern VAT g_VtxAttr[8];
 
+// The subset of CP state the FIFO preprocessor needs to find command sizes and
+// vertex array references. With the deterministic GPU thread, this runs ahead
+// of the GPU thread's copy of the same registers.
+struct CPState
+{
+	u32 array_bases[16];
+	u32 array_strides[16];
+	TVtxDesc vtx_desc;
+	VAT vtx_attr[8];
+};
+
+extern CPState g_preprocess_cp_state;
+
 // Might move this into its own file later.
 void LoadCPReg(u32 SubCmd, u32 Value);
+void LoadCPRegPreprocess(u32 SubCmd, u32 Value);
+void CopyPreprocessCPStateFromMain();
 
 // Fills memory with data from CP regs
 void FillCPMemoryArray(u32 *memory);
@@ -48,9 +48,11 @@ volatile bool interruptFinishWaiting = false;
 
 volatile u32 VITicks = CommandProcessor::m_cpClockOrigin;
 
+// With the deterministic GPU thread, the CPU thread reads the FIFO itself just
+// like in single core mode and hands preprocessed data to the GPU thread.
 static bool IsOnThread()
 {
-	return SConfig::GetInstance().m_LocalCoreStartupParameter.bCPUThread;
+	return SConfig::GetInstance().m_LocalCoreStartupParameter.bCPUThread && !g_use_deterministic_gpu_thread;
 }
 
 static void UpdateInterrupts_Wrapper(u64 userdata, int cyclesLate)
@@ -0,0 +1,289 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <unordered_map>
+#include <vector>
+
+#include "Common/Common.h"
+#include "Common/Hash.h"
+#include "Core/HW/Memmap.h"
+#include "VideoCommon/BPStructs.h"
+#include "VideoCommon/CPMemory.h"
+#include "VideoCommon/DataReader.h"
+#include "VideoCommon/DisplayListCache.h"
+#include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/RenderBase.h"
+#include "VideoCommon/Statistics.h"
+#include "VideoCommon/VertexLoaderManager.h"
+#include "VideoCommon/XFMemory.h"
+
+namespace DisplayListCache
+{
+
+enum
+{
+	// A list is compiled on its second call with the same contents
+	COMPILE_THRESHOLD = 2,
+	// Lists which haven't been called for that many frames are dropped
+	LIST_KILL_THRESHOLD = 200,
+	CLEANUP_INTERVAL = 60,
+};
+
+enum OpType
+{
+	OP_LOAD_CP_REG,
+	OP_LOAD_XF_REG,
+	OP_LOAD_INDEXED_XF,
+	OP_LOAD_BP_REG,
+	OP_CALL_DL,
+	OP_DRAW,
+};
+
+struct Op
+{
+	u8 type;
+	u8 arg8;    // CP sub command, XF transfer size, indexed XF array, vertex attribute group
+	u16 arg16;  // XF address, primitive
+	u32 value;  // register value, display list address, vertex count
+	u32 offset; // display list size, offset of XF data or vertex data, draw index
+};
+
+struct CachedList
+{
+	u32 size;
+	u64 hash;
+	int calls;
+	int last_frame;
+	bool compiled;
+	// The list ends in a truncated command, so it's left to the interpreter.
+	bool uncacheable;
+
+	std::vector<Op> ops;
+	std::vector<u32> xf_data;
+	// One for each OP_DRAW
+	std::vector<u32> draw_offsets;
+	std::vector<VertexLoaderManager::ConvertedVertices> draws;
+};
+
+static std::unordered_map<u32, CachedList> s_lists;
+static int s_last_cleanup_frame;
+
+static void Cleanup()
+{
+	auto iter = s_lists.begin();
+	while (iter != s_lists.end())
+	{
+		if (frameCount > LIST_KILL_THRESHOLD + iter->second.last_frame)
+			iter = s_lists.erase(iter);
+		else
+			++iter;
+	}
+}
+
+// Interprets the list like Decode does, recording what it does. Returns false
+// if a command is cut off by the end of the list, which Decode drops.
+static bool Compile(CachedList* list, u8* start)
+{
+	list->ops.clear();
+	list->xf_data.clear();
+	list->draw_offsets.clear();
+	list->draws.clear();
+
+	g_pVideoData = start;
+	u8* end = start + list->size;
+	while (g_pVideoData < end)
+	{
+		const u32 available = (u32)(end - g_pVideoData);
+		Op op = {};
+		int cmd_byte = DataReadU8();
+		switch (cmd_byte)
+		{
+		case GX_NOP:
+		case GX_CMD_UNKNOWN_METRICS:
+		case GX_CMD_INVL_VC:
+			continue;
+
+		case GX_LOAD_CP_REG:
+			if (available < 6)
+				return false;
+			op.type = OP_LOAD_CP_REG;
+			op.arg8 = DataReadU8();
+			op.value = DataReadU32();
+			LoadCPReg(op.arg8, op.value);
+			INCSTAT(stats.thisFrame.numCPLoads);
+			break;
+
+		case GX_LOAD_XF_REG:
+			{
+				if (available < 5)
+					return false;
+				u32 Cmd2 = DataPeek32(0);
+				u32 transfer_size = ((Cmd2 >> 16) & 15) + 1;
+				if (available < 5 + transfer_size * 4)
+					return false;
+				DataSkip(4);
+				op.type = OP_LOAD_XF_REG;
+				op.arg8 = transfer_size;
+				op.arg16 = Cmd2 & 0xFFFF;
+				op.offset = (u32)list->xf_data.size();
+				for (u32 i = 0; i < transfer_size; ++i)
+					list->xf_data.push_back(DataReadU32());
+				LoadXFReg(transfer_size, op.arg16, &list->xf_data[op.offset]);
+				INCSTAT(stats.thisFrame.numXFLoads);
+			}
+			break;
+
+		case GX_LOAD_INDX_A:
+		case GX_LOAD_INDX_B:
+		case GX_LOAD_INDX_C:
+		case GX_LOAD_INDX_D:
+			if (available < 5)
+				return false;
+			op.type = OP_LOAD_INDEXED_XF;
+			op.arg8 = 0xC + ((cmd_byte - GX_LOAD_INDX_A) >> 3);
+			op.value = DataReadU32();
+			LoadIndexedXF(op.value, op.arg8);
+			break;
+
+		case GX_CMD_CALL_DL:
+			if (available < 9)
+				return false;
+			op.type = OP_CALL_DL;
+			op.value = DataReadU32();
+			op.offset = DataReadU32();
+			InterpretDisplayList(op.value, op.offset);
+			break;
+
+		case GX_LOAD_BP_REG:
+			if (available < 5)
+				return false;
+			op.type = OP_LOAD_BP_REG;
+			op.value = DataReadU32();
+			LoadBPReg(op.value);
+			INCSTAT(stats.thisFrame.numBPLoads);
+			break;
+
+		default:
+			if ((cmd_byte & 0xC0) == 0x80)
+			{
+				if (available < 3)
+					return false;
+				u16 num_vertices = DataPeek16(0);
+				int vtx_attr_group = cmd_byte & GX_VAT_MASK;
+				if (available < 3 + num_vertices * (u32)VertexLoaderManager::GetVertexSize(vtx_attr_group))
+					return false;
+				DataSkip(2);
+
+				op.type = OP_DRAW;
+				op.arg8 = vtx_attr_group;
+				op.arg16 = (cmd_byte & GX_PRIMITIVE_MASK) >> GX_PRIMITIVE_SHIFT;
+				op.value = num_vertices;
+				op.offset = (u32)list->draws.size();
+				list->draw_offsets.push_back((u32)(g_pVideoData - start));
+				list->draws.emplace_back();
+				VertexLoaderManager::RunVertices(op.arg8, op.arg16, op.value, &list->draws.back());
+			}
+			else
+			{
+				ERROR_LOG(VIDEO, "DisplayListCache: Illegal command %02x", cmd_byte);
+				continue;
+			}
+			break;
+		}
+		list->ops.push_back(op);
+	}
+	return true;
+}
+
+static void Replay(CachedList* list, u8* start)
+{
+	for (const Op& op : list->ops)
+	{
+		switch (op.type)
+		{
+		case OP_LOAD_CP_REG:
+			LoadCPReg(op.arg8, op.value);
+			INCSTAT(stats.thisFrame.numCPLoads);
+			break;
+
+		case OP_LOAD_XF_REG:
+			LoadXFReg(op.arg8, op.arg16, &list->xf_data[op.offset]);
+			INCSTAT(stats.thisFrame.numXFLoads);
+			break;
+
+		case OP_LOAD_INDEXED_XF:
+			LoadIndexedXF(op.value, op.arg8);
+			break;
+
+		case OP_CALL_DL:
+			InterpretDisplayList(op.value, op.offset);
+			break;
+
+		case OP_LOAD_BP_REG:
+			LoadBPReg(op.value);
+			INCSTAT(stats.thisFrame.numBPLoads);
+			break;
+
+		case OP_DRAW:
+			{
+				VertexLoaderManager::ConvertedVertices& draw = list->draws[op.offset];
+				if (!draw.loader || !VertexLoaderManager::RunConvertedVertices(op.arg8, op.arg16, op.value, draw))
+				{
+					// The vertex state changed since the draw was recorded
+					g_pVideoData = start + list->draw_offsets[op.offset];
+					VertexLoaderManager::RunVertices(op.arg8, op.arg16, op.value, &draw);
+				}
+			}
+			break;
+		}
+	}
+}
+
+bool Run(u32 address, u32 size)
+{
+	u8* start = Memory::GetPointer(address);
+	if (!start || !size)
+		return false;
+
+	if (frameCount - s_last_cleanup_frame >= CLEANUP_INTERVAL)
+	{
+		Cleanup();
+		s_last_cleanup_frame = frameCount;
+	}
+
+	const u64 hash = GetHash64(start, size, 0);
+	CachedList& list = s_lists[address];
+	if (list.size != size || list.hash != hash)
+	{
+		list.size = size;
+		list.hash = hash;
+		list.calls = 0;
+		list.compiled = false;
+		list.uncacheable = false;
+	}
+	list.last_frame = frameCount;
+
+	if (list.uncacheable || ++list.calls < COMPILE_THRESHOLD)
+		return false;
+
+	if (list.compiled)
+	{
+		Replay(&list, start);
+	}
+	else
+	{
+		// Compiling runs the list, so it's done either way.
+		list.compiled = Compile(&list, start);
+		list.uncacheable = !list.compiled;
+	}
+	return true;
+}
+
+void Shutdown()
+{
+	s_lists.clear();
+	s_last_cleanup_frame = 0;
+}
+
+}
@@ -0,0 +1,22 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "Common/CommonTypes.h"
+
+// Display lists called repeatedly are parsed once into a list of register
+// writes and draws, which is replayed on later calls for as long as the
+// list's contents in RAM are unchanged. Draws whose vertices don't depend on
+// anything but the list itself are replayed from the converted vertices.
+namespace DisplayListCache
+{
+
+void Shutdown();
+
+// Runs the display list from the cache if possible.
+// Returns false if it has to be interpreted as usual.
+bool Run(u32 address, u32 size);
+
+}
@@ -2,12 +2,18 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <vector>
+
 #include "Common/Atomic.h"
 #include "Common/ChunkFile.h"
 #include "Common/FPURoundMode.h"
+#include "Common/MathUtil.h"
+#include "Common/MemArena.h"
 #include "Common/MemoryUtil.h"
 #include "Common/Thread.h"
 
+#include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
 #include "Core/HW/Memmap.h"
@@ -20,6 +26,7 @@
 #include "VideoCommon/VideoConfig.h"
 
 volatile bool g_bSkipCurrentFrame = false;
+bool g_use_deterministic_gpu_thread = false;
 
 namespace
 {
@@ -29,14 +36,73 @@ static std::mutex m_csHWVidOccupied;
 // STATE_TO_SAVE
 static u8 *videoBuffer;
 static int size = 0;
+
+// In dual core mode, videoBuffer is a ring buffer: the same pages are mapped
+// twice back to back, so a command that straddles the end can be read
+// linearly through the mirror, and new data never needs to be moved down.
+// g_pVideoData stays within the first mapping; the end (videoBuffer + size)
+// may run into the mirror. Falls back to a plain buffer if mapping fails.
+static MemArena s_video_buffer_arena;
+static bool s_video_buffer_mirrored;
+
+// Deterministic GPU thread: the CPU thread copies new FIFO data to the end of
+// videoBuffer, preprocesses every complete command and then publishes the new
+// end in s_video_buffer_write_size. The GPU thread decodes up to that point
+// and reports back through s_video_buffer_seen_size; in this mode 'size' and
+// g_pVideoData belong to the GPU thread.
+static volatile u32 s_video_buffer_write_size;
+static volatile u32 s_video_buffer_seen_size;
+static u8 *s_video_buffer_pp_read_ptr;
+static bool s_sync_after_preprocess;
+
+// Copies of RAM referenced by commands (display lists, vertex arrays, indexed
+// XF loads), pushed by the preprocessor in the same order the GPU thread pops them.
+static u8 *s_fifo_aux_data;
+static u32 s_fifo_aux_size;
+static u32 s_fifo_aux_write_ptr;
+static volatile u32 s_fifo_aux_read_ptr;
 }  // namespace
 
+// Moves whatever is left to decode to the start of videoBuffer.
+static void CompactVideoBuffer()
+{
+	int pos = (int)(g_pVideoData - videoBuffer);
+	size -= pos;
+	if (s_video_buffer_mirrored)
+	{
+		// The tail may lie in the mirror, which maps the same pages as the
+		// destination, so memmove can't see that the ranges overlap.
+		std::vector<u8> tail(&videoBuffer[pos], &videoBuffer[pos + size]);
+		memcpy(&videoBuffer[0], tail.data(), size);
+	}
+	else
+	{
+		memmove(&videoBuffer[0], &videoBuffer[pos], size);
+	}
+	g_pVideoData = videoBuffer;
+}
+
 void Fifo_DoState(PointerWrap &p)
 {
+	// Savestates don't know about the mirror.
+	if (p.GetMode() != PointerWrap::MODE_READ && size > FIFO_SIZE)
+		CompactVideoBuffer();
+
 	p.DoArray(videoBuffer, FIFO_SIZE);
 	p.Do(size);
 	p.DoPointer(g_pVideoData, videoBuffer);
 	p.Do(g_bSkipCurrentFrame);
+
+	if (p.GetMode() == PointerWrap::MODE_READ && g_use_deterministic_gpu_thread)
+	{
+		// The GPU thread has consumed everything while the state is locked, so
+		// only a partial command can be left over in the buffer.
+		s_video_buffer_pp_read_ptr = g_pVideoData;
+		s_video_buffer_seen_size = size;
+		s_video_buffer_write_size = size;
+		s_fifo_aux_write_ptr = 0;
+		s_fifo_aux_read_ptr = 0;
+	}
 }
 
 void Fifo_PauseAndLock(bool doLock, bool unpauseOnUnlock)
@@ -58,10 +124,58 @@ void Fifo_PauseAndLock(bool doLock, bool unpauseOnUnlock)
 }
 
 
+static u8* AllocateMirroredVideoBuffer()
+{
+	// The deterministic GPU thread compacts the buffer itself.
+	if (g_use_deterministic_gpu_thread)
+		return nullptr;
+
+	s_video_buffer_arena.GrabLowMemSpace(FIFO_SIZE);
+
+	// Same approach as MemArena::Find4GBBase: find a free range, release it and
+	// hope nobody grabs it before the views are in place.
+	for (int attempt = 0; attempt < 8; ++attempt)
+	{
+		u8* base = (u8*)AllocateMemoryPages(2 * FIFO_SIZE);
+		if (!base)
+			break;
+		FreeMemoryPages(base, 2 * FIFO_SIZE);
+
+		u8* view = (u8*)s_video_buffer_arena.CreateView(0, FIFO_SIZE, base);
+		u8* mirror = (u8*)s_video_buffer_arena.CreateView(0, FIFO_SIZE, base + FIFO_SIZE);
+		if (view == base && mirror == base + FIFO_SIZE)
+			return base;
+
+		if (view)
+			s_video_buffer_arena.ReleaseView(view, FIFO_SIZE);
+		if (mirror)
+			s_video_buffer_arena.ReleaseView(mirror, FIFO_SIZE);
+	}
+
+	WARN_LOG(VIDEO, "Failed to map the video buffer as a ring buffer");
+	s_video_buffer_arena.ReleaseSpace();
+	return nullptr;
+}
+
 void Fifo_Init()
 {
-	videoBuffer = (u8*)AllocateMemoryPages(FIFO_SIZE);
+	const SCoreStartupParameter& param = SConfig::GetInstance().m_LocalCoreStartupParameter;
+	g_use_deterministic_gpu_thread = param.bCPUThread && param.bDeterministicGPUThread;
+
+	videoBuffer = AllocateMirroredVideoBuffer();
+	s_video_buffer_mirrored = videoBuffer != nullptr;
+	if (!s_video_buffer_mirrored)
+		videoBuffer = (u8*)AllocateMemoryPages(FIFO_SIZE);
+	// Readers of vertex arrays may overrun the end of the copied data slightly.
+	s_fifo_aux_data = (u8*)AllocateMemoryPages(FIFO_SIZE + 32);
+	s_fifo_aux_size = FIFO_SIZE;
 	size = 0;
+	s_video_buffer_write_size = 0;
+	s_video_buffer_seen_size = 0;
+	s_video_buffer_pp_read_ptr = videoBuffer;
+	s_sync_after_preprocess = false;
+	s_fifo_aux_write_ptr = 0;
+	s_fifo_aux_read_ptr = 0;
 	GpuRunningState = false;
 	Common::AtomicStore(CommandProcessor::VITicks, CommandProcessor::m_cpClockOrigin);
 }
@@ -69,8 +183,19 @@ void Fifo_Init()
 void Fifo_Shutdown()
 {
 	if (GpuRunningState) PanicAlert("Fifo shutting down while active");
-	FreeMemoryPages(videoBuffer, FIFO_SIZE);
+	if (s_video_buffer_mirrored)
+	{
+		s_video_buffer_arena.ReleaseView(videoBuffer, FIFO_SIZE);
+		s_video_buffer_arena.ReleaseView(videoBuffer + FIFO_SIZE, FIFO_SIZE);
+		s_video_buffer_arena.ReleaseSpace();
+	}
+	else
+	{
+		FreeMemoryPages(videoBuffer, FIFO_SIZE);
+	}
 	videoBuffer = nullptr;
+	FreeMemoryPages(s_fifo_aux_data, s_fifo_aux_size + 32);
+	s_fifo_aux_data = nullptr;
 }
 
 u8* GetVideoBufferStartPtr()
@@ -110,16 +235,29 @@ void EmulatorState(bool running)
 // Description: RunGpuLoop() sends data through this function.
 void ReadDataFromFifo(u8* _uData, u32 len)
 {
-	if (size + len >= FIFO_SIZE)
+	if (s_video_buffer_mirrored)
 	{
+		if (g_pVideoData >= videoBuffer + FIFO_SIZE)
+		{
+			g_pVideoData -= FIFO_SIZE;
+			size -= FIFO_SIZE;
+		}
 		int pos = (int)(g_pVideoData - videoBuffer);
-		size -= pos;
-		if (size + len > FIFO_SIZE)
+		if (size - pos + len > FIFO_SIZE)
 		{
-			PanicAlert("FIFO out of bounds (size = %i, len = %i at %08x)", size, len, pos);
+			PanicAlert("FIFO out of bounds (size = %i, len = %i at %08x)", size - pos, len, pos);
+			return;
 		}
-		memmove(&videoBuffer[0], &videoBuffer[pos], size);
-		g_pVideoData = videoBuffer;
+	}
+	else if (size + len >= FIFO_SIZE)
+	{
+		int pos = (int)(g_pVideoData - videoBuffer);
+		if (size - pos + len > FIFO_SIZE)
+		{
+			PanicAlert("FIFO out of bounds (size = %i, len = %i at %08x)", size - pos, len, pos);
+			return;
+		}
+		CompactVideoBuffer();
 	}
 	// Copy new video instructions to videoBuffer for future use in rendering the new picture
 	memcpy(videoBuffer + size, _uData, len);
@@ -128,10 +266,137 @@ void ReadDataFromFifo(u8* _uData, u32 len)
 
 void ResetVideoBuffer()
 {
+	if (g_use_deterministic_gpu_thread)
+	{
+		SyncGPU(false);
+		s_video_buffer_pp_read_ptr = videoBuffer;
+		g_pVideoData = videoBuffer;
+		size = 0;
+		Common::AtomicStore(s_video_buffer_write_size, 0);
+		Common::AtomicStoreRelease(s_video_buffer_seen_size, 0);
+		return;
+	}
+
 	g_pVideoData = videoBuffer;
 	size = 0;
 }
 
+// Waits until the GPU thread has decoded everything published so far. This is
+// the only point where the CPU thread blocks on the deterministic GPU thread.
+void SyncGPU(bool may_move_read_ptr)
+{
+	if (!g_use_deterministic_gpu_thread)
+		return;
+
+	while (GpuRunningState && Common::AtomicLoadAcquire(s_video_buffer_seen_size) != s_video_buffer_write_size)
+		Common::YieldCPU();
+
+	if (!GpuRunningState)
+		return;
+
+	// Opportunistically move everything back to the start of the buffers so we
+	// don't wrap around. Anything the preprocessor pushed that hasn't been
+	// published yet lies between the aux read and write pointers.
+	u32 aux_read_ptr = s_fifo_aux_read_ptr;
+	memmove(s_fifo_aux_data, s_fifo_aux_data + aux_read_ptr, s_fifo_aux_write_ptr - aux_read_ptr);
+	s_fifo_aux_write_ptr -= aux_read_ptr;
+	Common::AtomicStore(s_fifo_aux_read_ptr, 0);
+
+	if (may_move_read_ptr)
+	{
+		// What's left over is a partial command the GPU thread hasn't seen.
+		u32 leftover = s_video_buffer_write_size - (u32)(s_video_buffer_pp_read_ptr - videoBuffer);
+		memmove(videoBuffer, s_video_buffer_pp_read_ptr, leftover);
+		s_video_buffer_pp_read_ptr = videoBuffer;
+		g_pVideoData = videoBuffer;
+		size = leftover;
+		// The GPU thread reads seen before write and only decodes when write is
+		// larger, so storing write first keeps it from decoding a stale range.
+		Common::AtomicStore(s_video_buffer_write_size, leftover);
+		Common::AtomicStoreRelease(s_video_buffer_seen_size, leftover);
+	}
+}
+
+void PushFifoAuxBuffer(const void* ptr, u32 len)
+{
+	// Entries start on 16 byte boundaries, but only len bytes of the source
+	// may be read.
+	u32 aligned_len = ROUND_UP(len, 16);
+	if (aligned_len > s_fifo_aux_size - s_fifo_aux_write_ptr)
+	{
+		SyncGPU(false);
+		if (aligned_len > s_fifo_aux_size - s_fifo_aux_write_ptr)
+		{
+			// Syncing leaves only what the current 32 bytes of FIFO data have
+			// pushed, so this takes a multi-megabyte display list. The GPU
+			// thread is idle now, so the buffer can be replaced by a larger one.
+			u32 new_size = std::max(2 * s_fifo_aux_size, ROUND_UP(s_fifo_aux_write_ptr + aligned_len, 16));
+			u8* new_data = (u8*)AllocateMemoryPages(new_size + 32);
+			memcpy(new_data, s_fifo_aux_data, s_fifo_aux_write_ptr);
+			FreeMemoryPages(s_fifo_aux_data, s_fifo_aux_size + 32);
+			s_fifo_aux_data = new_data;
+			s_fifo_aux_size = new_size;
+		}
+	}
+	memcpy(s_fifo_aux_data + s_fifo_aux_write_ptr, ptr, len);
+	s_fifo_aux_write_ptr += aligned_len;
+}
+
+void* PopFifoAuxBuffer(u32 len)
+{
+	u8* ret = s_fifo_aux_data + s_fifo_aux_read_ptr;
+	Common::AtomicStore(s_fifo_aux_read_ptr, s_fifo_aux_read_ptr + ROUND_UP(len, 16));
+	return ret;
+}
+
+// Description: RunGpu() sends data through this function when the deterministic
+// GPU thread is in use. Runs on the CPU thread.
+static void ReadDataFromFifoOnCPU(u8* _uData, u32 len)
+{
+	if (s_video_buffer_write_size + len > FIFO_SIZE)
+	{
+		// We can't wrap around while the GPU thread is working on the data.
+		SyncGPU();
+		if (s_video_buffer_write_size + len > FIFO_SIZE)
+		{
+			PanicAlert("FIFO out of bounds (size = %u, len = %u)", s_video_buffer_write_size, len);
+			return;
+		}
+	}
+	u32 write_size = s_video_buffer_write_size;
+	memcpy(videoBuffer + write_size, _uData, len);
+	write_size += len;
+
+	bool sync_needed = false;
+	s_video_buffer_pp_read_ptr = OpcodeDecoder_Preprocess(s_video_buffer_pp_read_ptr, videoBuffer + write_size, &sync_needed);
+	s_sync_after_preprocess |= sync_needed;
+
+	Common::AtomicStoreRelease(s_video_buffer_write_size, write_size);
+
+	if (s_sync_after_preprocess)
+	{
+		s_sync_after_preprocess = false;
+		SyncGPU();
+	}
+}
+
+
+// How many bytes RunGpuLoop can consume at once starting at read_ptr when bulk
+// reads are on: all of the pending data that is contiguous in RAM, stopping at
+// a breakpoint.
+static u32 GetFifoReadSize(u32 read_ptr)
+{
+	SCPFifoStruct &fifo = CommandProcessor::fifo;
+	u32 len = std::min<u32>(Common::AtomicLoad(fifo.CPReadWriteDistance), fifo.CPEnd - read_ptr + 32);
+
+	// Leave room for a partial command in the buffer.
+	len = std::min<u32>(len, FIFO_SIZE / 2);
+
+	if (fifo.bFF_BPEnable && fifo.CPBreakpoint > read_ptr && fifo.CPBreakpoint - read_ptr < len)
+		len = fifo.CPBreakpoint - read_ptr;
+
+	return std::max<u32>(len & ~31, 32);
+}
 
 // Description: Main FIFO update loop
 // Purpose: Keep the Core HW updated about the CPU-GPU distance
@@ -146,55 +411,82 @@ void RunGpuLoop()
 	{
 		g_video_backend->PeekMessages();
 
-		VideoFifo_CheckAsyncRequest();
-
-		CommandProcessor::SetCpStatus();
-
-		Common::AtomicStore(CommandProcessor::VITicks, CommandProcessor::m_cpClockOrigin);
-
-		// check if we are able to run this buffer
-		while (GpuRunningState && !CommandProcessor::interruptWaiting && fifo.bFF_GPReadEnable && fifo.CPReadWriteDistance && !AtBreakpoint())
+		if (g_use_deterministic_gpu_thread)
 		{
-			fifo.isGpuReadingData = true;
-			CommandProcessor::isPossibleWaitingSetDrawDone = fifo.bFF_GPLinkEnable ? true : false;
+			VideoFifo_CheckAsyncRequest();
 
-			if (!Core::g_CoreStartupParameter.bSyncGPU || Common::AtomicLoad(CommandProcessor::VITicks) > CommandProcessor::m_cpClockOrigin)
+			// All the fifo/CP state lives on the CPU thread; we only need to run
+			// the opcode decoder on what it has preprocessed. See the comment in
+			// SyncGPU for the order of these loads.
+			u32 seen_size = Common::AtomicLoadAcquire(s_video_buffer_seen_size);
+			u32 write_size = Common::AtomicLoadAcquire(s_video_buffer_write_size);
+			if (write_size > seen_size)
 			{
-				u32 readPtr = fifo.CPReadPointer;
-				u8 *uData = Memory::GetPointer(readPtr);
-
-				if (readPtr == fifo.CPEnd)
-					readPtr = fifo.CPBase;
-				else
-					readPtr += 32;
-
-				_assert_msg_(COMMANDPROCESSOR, (s32)fifo.CPReadWriteDistance - 32 >= 0 ,
-					"Negative fifo.CPReadWriteDistance = %i in FIFO Loop !\nThat can produce instability in the game. Please report it.", fifo.CPReadWriteDistance - 32);
-
-				ReadDataFromFifo(uData, 32);
+				size = write_size;
+				OpcodeDecoder_Run(g_bSkipCurrentFrame);
+				Common::AtomicStoreRelease(s_video_buffer_seen_size, write_size);
+			}
+		}
+		else
+		{
+			VideoFifo_CheckAsyncRequest();
 
-				cyclesExecuted = OpcodeDecoder_Run(g_bSkipCurrentFrame);
+			CommandProcessor::SetCpStatus();
 
-				if (Core::g_CoreStartupParameter.bSyncGPU && Common::AtomicLoad(CommandProcessor::VITicks) > cyclesExecuted)
-					Common::AtomicAdd(CommandProcessor::VITicks, -(s32)cyclesExecuted);
+			Common::AtomicStore(CommandProcessor::VITicks, CommandProcessor::m_cpClockOrigin);
 
-				Common::AtomicStore(fifo.CPReadPointer, readPtr);
-				Common::AtomicAdd(fifo.CPReadWriteDistance, -32);
-				if ((GetVideoBufferEndPtr() - g_pVideoData) == 0)
-					Common::AtomicStore(fifo.SafeCPReadPointer, fifo.CPReadPointer);
+			// check if we are able to run this buffer
+			while (GpuRunningState && !CommandProcessor::interruptWaiting && fifo.bFF_GPReadEnable && fifo.CPReadWriteDistance && !AtBreakpoint())
+			{
+				fifo.isGpuReadingData = true;
+				CommandProcessor::isPossibleWaitingSetDrawDone = fifo.bFF_GPLinkEnable ? true : false;
+
+				if (!Core::g_CoreStartupParameter.bSyncGPU || Common::AtomicLoad(CommandProcessor::VITicks) > CommandProcessor::m_cpClockOrigin)
+				{
+					u32 readPtr = fifo.CPReadPointer;
+					u8 *uData = Memory::GetPointer(readPtr);
+
+					// Bulk reads take everything up to the wrap point in one go. The
+					// interrupt check above then only runs between spans, so a CP
+					// interrupt raised early in a span is seen late: that's why
+					// they're opt-in. SyncGPU paces the GPU per 32 byte block.
+					u32 len = 32;
+					if (Core::g_CoreStartupParameter.bBulkFifoReads && !Core::g_CoreStartupParameter.bSyncGPU)
+						len = GetFifoReadSize(readPtr);
+
+					if (readPtr + len - 32 == fifo.CPEnd)
+						readPtr = fifo.CPBase;
+					else
+						readPtr += len;
+
+					_assert_msg_(COMMANDPROCESSOR, (s32)fifo.CPReadWriteDistance - (s32)len >= 0 ,
+						"Negative fifo.CPReadWriteDistance = %i in FIFO Loop !\nThat can produce instability in the game. Please report it.", fifo.CPReadWriteDistance - len);
+
+					ReadDataFromFifo(uData, len);
+
+					cyclesExecuted = OpcodeDecoder_Run(g_bSkipCurrentFrame);
+
+					if (Core::g_CoreStartupParameter.bSyncGPU && Common::AtomicLoad(CommandProcessor::VITicks) > cyclesExecuted)
+						Common::AtomicAdd(CommandProcessor::VITicks, -(s32)cyclesExecuted);
+
+					Common::AtomicStore(fifo.CPReadPointer, readPtr);
+					Common::AtomicAdd(fifo.CPReadWriteDistance, -(s32)len);
+					if ((GetVideoBufferEndPtr() - g_pVideoData) == 0)
+						Common::AtomicStore(fifo.SafeCPReadPointer, fifo.CPReadPointer);
+				}
+
+				CommandProcessor::SetCpStatus();
+
+				// This call is pretty important in DualCore mode and must be called in the FIFO Loop.
+				// If we don't, s_swapRequested or s_efbAccessRequested won't be set to false
+				// leading the CPU thread to wait in Video_BeginField or Video_AccessEFB thus slowing things down.
+				VideoFifo_CheckAsyncRequest();
+				CommandProcessor::isPossibleWaitingSetDrawDone = false;
 			}
 
-			CommandProcessor::SetCpStatus();
-
-			// This call is pretty important in DualCore mode and must be called in the FIFO Loop.
-			// If we don't, s_swapRequested or s_efbAccessRequested won't be set to false
-			// leading the CPU thread to wait in Video_BeginField or Video_AccessEFB thus slowing things down.
-			VideoFifo_CheckAsyncRequest();
-			CommandProcessor::isPossibleWaitingSetDrawDone = false;
+			fifo.isGpuReadingData = false;
 		}
 
-		fifo.isGpuReadingData = false;
-
 		if (EmuRunningState)
 		{
 			// NOTE(jsd): Calling SwitchToThread() on Windows 7 x64 is a hot spot, according to profiler.
@@ -204,6 +496,12 @@ void RunGpuLoop()
 			Common::YieldCPU();
 #endif
 		}
+		else if (g_use_deterministic_gpu_thread &&
+		         Common::AtomicLoadAcquire(s_video_buffer_write_size) != Common::AtomicLoad(s_video_buffer_seen_size))
+		{
+			// Finish what the CPU thread published before it was paused, so a
+			// savestate never sees half-consumed preprocessed data.
+		}
 		else
 		{
 			// While the emu is paused, we still handle async requests then sleep.
@@ -232,11 +530,18 @@ void RunGpu()
 	{
 		u8 *uData = Memory::GetPointer(fifo.CPReadPointer);
 
-		FPURoundMode::SaveSIMDState();
-		FPURoundMode::LoadDefaultSIMDState();
-		ReadDataFromFifo(uData, 32);
-		OpcodeDecoder_Run(g_bSkipCurrentFrame);
-		FPURoundMode::LoadSIMDState();
+		if (g_use_deterministic_gpu_thread)
+		{
+			ReadDataFromFifoOnCPU(uData, 32);
+		}
+		else
+		{
+			FPURoundMode::SaveSIMDState();
+			FPURoundMode::LoadDefaultSIMDState();
+			ReadDataFromFifo(uData, 32);
+			OpcodeDecoder_Run(g_bSkipCurrentFrame);
+			FPURoundMode::LoadSIMDState();
+		}
 
 		//DEBUG_LOG(COMMANDPROCESSOR, "Fifo wraps to base");
 
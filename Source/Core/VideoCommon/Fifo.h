@@ -13,6 +13,11 @@ class PointerWrap;
 
 extern volatile bool g_bSkipCurrentFrame;
 
+// When set, the CPU thread preprocesses FIFO data as it is written (firing PE
+// tokens and copying referenced RAM into the command stream), so the GPU thread
+// never has to be waited on except for explicit syncs.
+extern bool g_use_deterministic_gpu_thread;
+
 
 void Fifo_Init();
 void Fifo_Shutdown();
@@ -25,6 +30,11 @@ void Fifo_PauseAndLock(bool doLock, bool unpauseOnUnlock);
 
 void ReadDataFromFifo(u8* _uData, u32 len);
 
+// Deterministic GPU thread only.
+void SyncGPU(bool may_move_read_ptr = true);
+void PushFifoAuxBuffer(const void* ptr, u32 len);
+void* PopFifoAuxBuffer(u32 len);
+
 void RunGpu();
 void RunGpuLoop();
 void ExitGpuLoop();
@@ -4,6 +4,10 @@
 
 #include <cstddef>
 
+#ifdef _M_X86
+#include <emmintrin.h>
+#endif
+
 #include "Common/Common.h"
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/OpcodeDecoding.h"
@@ -16,6 +20,50 @@ u32 IndexGenerator::base_index;
 
 static const u16 s_primitive_restart = -1;
 
+#ifdef _M_X86
+// Index patterns for the SSE2 versions: each entry is either an offset from
+// the base index of the block, or one of these.
+static const u16 R = 0xFFFF; // primitive restart
+static const u16 C = 0xFFFE; // center of a fan
+
+// Writes blocks of 8 * vectors indices following pattern, the base index
+// increasing by step after each block.
+template <int vectors>
+static u16* WriteIndexBlocks(u16* Iptr, u32 blocks, u32 base, u32 step, const u16 (&pattern)[vectors * 8], u32 center = 0)
+{
+	__m128i offsets[vectors], fixed_mask[vectors], fixed[vectors];
+	for (int v = 0; v < vectors; ++v)
+	{
+		u16 o[8], m[8], f[8];
+		for (int j = 0; j < 8; ++j)
+		{
+			const u16 p = pattern[v * 8 + j];
+			const bool is_fixed = p == R || p == C;
+			o[j] = is_fixed ? 0 : p;
+			m[j] = is_fixed ? 0xFFFF : 0;
+			f[j] = p == R ? s_primitive_restart : p == C ? (u16)center : 0;
+		}
+		offsets[v] = _mm_loadu_si128((const __m128i*)o);
+		fixed_mask[v] = _mm_loadu_si128((const __m128i*)m);
+		fixed[v] = _mm_loadu_si128((const __m128i*)f);
+	}
+
+	__m128i b = _mm_set1_epi16((u16)base);
+	const __m128i s = _mm_set1_epi16((u16)step);
+	for (u32 i = 0; i < blocks; ++i)
+	{
+		for (int v = 0; v < vectors; ++v)
+		{
+			__m128i indices = _mm_andnot_si128(fixed_mask[v], _mm_add_epi16(offsets[v], b));
+			_mm_storeu_si128((__m128i*)Iptr + v, _mm_or_si128(indices, fixed[v]));
+		}
+		Iptr += vectors * 8;
+		b = _mm_add_epi16(b, s);
+	}
+	return Iptr;
+}
+#endif
+
 static u16* (*primitive_table[8])(u16*, u32, u32);
 
 void IndexGenerator::Init()
@@ -67,7 +115,24 @@ template <bool pr> __forceinline u16* IndexGenerator::WriteTriangle(u16 *Iptr, u
 
 template <bool pr> u16* IndexGenerator::AddList(u16 *Iptr, u32 const numVerts, u32 index)
 {
-	for (u32 i = 2; i < numVerts; i+=3)
+	u32 i = 2;
+#ifdef _M_X86
+	if (pr)
+	{
+		static const u16 pattern[8] = { 0, 1, 2, R, 3, 4, 5, R };
+		const u32 blocks = numVerts / 6;
+		Iptr = WriteIndexBlocks<1>(Iptr, blocks, index, 6, pattern);
+		i += blocks * 6;
+	}
+	else
+	{
+		static const u16 pattern[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+		const u32 blocks = numVerts / 24 * 3;
+		Iptr = WriteIndexBlocks<1>(Iptr, blocks, index, 8, pattern);
+		i += blocks * 8;
+	}
+#endif
+	for (; i < numVerts; i+=3)
 	{
 		Iptr = WriteTriangle<pr>(Iptr, index + i - 2, index + i - 1, index + i);
 	}
@@ -78,7 +143,13 @@ template <bool pr> u16* IndexGenerator::AddStrip(u16 *Iptr, u32 const numVerts,
 {
 	if (pr)
 	{
-		for (u32 i = 0; i < numVerts; ++i)
+		u32 i = 0;
+#ifdef _M_X86
+		static const u16 pattern[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+		Iptr = WriteIndexBlocks<1>(Iptr, numVerts / 8, index, 8, pattern);
+		i = numVerts / 8 * 8;
+#endif
+		for (; i < numVerts; ++i)
 		{
 			*Iptr++ = index + i;
 		}
@@ -88,7 +159,21 @@ template <bool pr> u16* IndexGenerator::AddStrip(u16 *Iptr, u32 const numVerts,
 	else
 	{
 		bool wind = false;
-		for (u32 i = 2; i < numVerts; ++i)
+		u32 i = 2;
+#ifdef _M_X86
+		// 8 triangles, so that the winding is the same after each block
+		static const u16 pattern[24] = {
+			0, 1, 2, 1, 3, 2, 2, 3, 4, 3, 5, 4,
+			4, 5, 6, 5, 7, 6, 6, 7, 8, 7, 9, 8,
+		};
+		if (numVerts > 2)
+		{
+			const u32 blocks = (numVerts - 2) / 8;
+			Iptr = WriteIndexBlocks<3>(Iptr, blocks, index, 8, pattern);
+			i += blocks * 8;
+		}
+#endif
+		for (; i < numVerts; ++i)
 		{
 			Iptr = WriteTriangle<pr>(Iptr,
 				index + i - 2,
@@ -126,6 +211,18 @@ template <bool pr> u16* IndexGenerator::AddFan(u16 *Iptr, u32 numVerts, u32 inde
 
 	if (pr)
 	{
+#ifdef _M_X86
+		static const u16 pattern[24] = {
+			0, 1, C, 2, 3, R, 3, 4, C, 5, 6, R,
+			6, 7, C, 8, 9, R, 9, 10, C, 11, 12, R,
+		};
+		if (numVerts > 2)
+		{
+			const u32 blocks = (numVerts - 2) / 12;
+			Iptr = WriteIndexBlocks<3>(Iptr, blocks, index + 1, 12, pattern, index);
+			i += blocks * 12;
+		}
+#endif
 		for (; i+3<=numVerts; i+=3)
 		{
 			*Iptr++ = index + i - 1;
@@ -145,6 +242,18 @@ template <bool pr> u16* IndexGenerator::AddFan(u16 *Iptr, u32 numVerts, u32 inde
 			*Iptr++ = s_primitive_restart;
 		}
 	}
+#ifdef _M_X86
+	else if (numVerts > 2)
+	{
+		static const u16 pattern[24] = {
+			C, 1, 2, C, 2, 3, C, 3, 4, C, 4, 5,
+			C, 5, 6, C, 6, 7, C, 7, 8, C, 8, 9,
+		};
+		const u32 blocks = (numVerts - 2) / 8;
+		Iptr = WriteIndexBlocks<3>(Iptr, blocks, index, 8, pattern, index);
+		i += blocks * 8;
+	}
+#endif
 
 	for (; i < numVerts; ++i)
 	{
@@ -173,6 +282,28 @@ template <bool pr> u16* IndexGenerator::AddFan(u16 *Iptr, u32 numVerts, u32 inde
 template <bool pr> u16* IndexGenerator::AddQuads(u16 *Iptr, u32 numVerts, u32 index)
 {
 	u32 i = 3;
+#ifdef _M_X86
+	if (pr)
+	{
+		static const u16 pattern[40] = {
+			1, 2, 0, 3, R, 5, 6, 4, 7, R, 9, 10, 8, 11, R, 13, 14, 12, 15, R,
+			17, 18, 16, 19, R, 21, 22, 20, 23, R, 25, 26, 24, 27, R, 29, 30, 28, 31, R,
+		};
+		const u32 blocks = numVerts / 32;
+		Iptr = WriteIndexBlocks<5>(Iptr, blocks, index, 32, pattern);
+		i += blocks * 32;
+	}
+	else
+	{
+		static const u16 pattern[24] = {
+			0, 1, 2, 0, 2, 3, 4, 5, 6, 4, 6, 7,
+			8, 9, 10, 8, 10, 11, 12, 13, 14, 12, 14, 15,
+		};
+		const u32 blocks = numVerts / 16;
+		Iptr = WriteIndexBlocks<3>(Iptr, blocks, index, 16, pattern);
+		i += blocks * 16;
+	}
+#endif
 	for (; i < numVerts; i+=4)
 	{
 		if (pr)
@@ -4,6 +4,7 @@
 
 #include "VideoCommon/BPStructs.h"
 #include "VideoCommon/CommandProcessor.h"
+#include "VideoCommon/CPMemory.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/FramebufferManagerBase.h"
 #include "VideoCommon/MainBase.h"
@@ -150,6 +151,8 @@ u32 VideoBackendHardware::Video_AccessEFB(EFBAccessType type, u32 x, u32 y, u32
 {
 	if (s_BackendInitialized && g_ActiveConfig.bEFBAccessEnable)
 	{
+		SyncGPU();
+
 		s_accessEFBArgs.type = type;
 		s_accessEFBArgs.x = x;
 		s_accessEFBArgs.y = y;
@@ -199,6 +202,8 @@ u32 VideoBackendHardware::Video_GetQueryResult(PerfQueryType type)
 		return 0;
 	}
 
+	SyncGPU();
+
 	// TODO: Is this check sane?
 	if (!g_perf_query->IsFlushed())
 	{
@@ -256,6 +261,7 @@ void VideoBackendHardware::DoState(PointerWrap& p)
 	{
 		m_invalid = true;
 		RecomputeCachedArraybases();
+		CopyPreprocessCPStateFromMain();
 
 		// Clear all caches that touch RAM
 		// (? these don't appear to touch any emulation state that gets saved. moved to on load only.)
@@ -19,9 +19,11 @@
 #include "Core/FifoPlayer/FifoRecorder.h"
 #include "Core/HW/Memmap.h"
 #include "VideoCommon/BPMemory.h"
+#include "VideoCommon/BPStructs.h"
 #include "VideoCommon/CommandProcessor.h"
 #include "VideoCommon/CPMemory.h"
 #include "VideoCommon/DataReader.h"
+#include "VideoCommon/DisplayListCache.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/OpcodeDecoding.h"
 #include "VideoCommon/Statistics.h"
@@ -75,12 +77,60 @@ static DataReadU32xNfunc DataReadU32xFuncs[16] = {
 	DataReadU32xN<16>
 };
 
-static void Decode();
+template <bool is_skipped_frame>
+static u32 Decode(u8* end);
+
+// Unknown opcodes are only reported to the user when they come from the FIFO.
+// Inside display lists they are just logged.
+static bool s_in_display_list;
+
+// With the deterministic GPU thread, display lists are read from the copy the
+// preprocessor pushed to the aux buffer rather than from emulated RAM.
+static u8* PopDisplayList(u32* size)
+{
+	*size = *(u32*)PopFifoAuxBuffer(sizeof(u32));
+	return (u8*)PopFifoAuxBuffer(*size);
+}
+
+// Only used with the deterministic GPU thread, where skipped display lists
+// still have to be walked to keep the aux buffer in sync.
+static void InterpretDisplayListSemiNop()
+{
+	u8* old_pVideoData = g_pVideoData;
+
+	u32 size;
+	g_pVideoData = PopDisplayList(&size);
+	u8 *end = g_pVideoData + size;
+	bool was_in_display_list = s_in_display_list;
+	s_in_display_list = true;
+	while (Decode<true>(end))
+	{
+	}
+	s_in_display_list = was_in_display_list;
+
+	g_pVideoData = old_pVideoData;
+}
 
 void InterpretDisplayList(u32 address, u32 size)
 {
+	// The FIFO recorder needs to see the commands of display lists
+	if (g_ActiveConfig.bDlistCachingEnable && !g_use_deterministic_gpu_thread && !g_bRecordFifoData)
+	{
+		u8* old_pVideoData = g_pVideoData;
+		Statistics::SwapDL();
+		bool cached = DisplayListCache::Run(address, size);
+		Statistics::SwapDL();
+		g_pVideoData = old_pVideoData;
+
+		if (cached)
+		{
+			INCSTAT(stats.thisFrame.numDListsCalled);
+			return;
+		}
+	}
+
 	u8* old_pVideoData = g_pVideoData;
-	u8* startAddress = Memory::GetPointer(address);
+	u8* startAddress = g_use_deterministic_gpu_thread ? PopDisplayList(&size) : Memory::GetPointer(address);
 
 	// Avoid the crash if Memory::GetPointer failed ..
 	if (startAddress != nullptr)
@@ -90,11 +140,14 @@ void InterpretDisplayList(u32 address, u32 size)
 		// temporarily swap dl and non-dl (small "hack" for the stats)
 		Statistics::SwapDL();
 
+		// A command cut off by the end of the list is dropped
 		u8 *end = g_pVideoData + size;
-		while (g_pVideoData < end)
+		bool was_in_display_list = s_in_display_list;
+		s_in_display_list = true;
+		while (Decode<false>(end))
 		{
-			Decode();
 		}
+		s_in_display_list = was_in_display_list;
 		INCSTAT(stats.thisFrame.numDListsCalled);
 
 		// un-swap
@@ -105,238 +158,146 @@ void InterpretDisplayList(u32 address, u32 size)
 	g_pVideoData = old_pVideoData;
 }
 
-static u32 FifoCommandRunnable(u32 &command_size)
+static void UnknownOpcode(u8 cmd_byte)
 {
-	u32 cycleTime = 0;
-	u32 buffer_size = (u32)(GetVideoBufferEndPtr() - g_pVideoData);
-	if (buffer_size == 0)
-		return 0;  // can't peek
-
-	u8 cmd_byte = DataPeek8(0);
-
-	switch (cmd_byte)
+	// TODO(Omega): Maybe dump FIFO to file on this error
+	std::string temp = StringFromFormat(
+		"GFX FIFO: Unknown Opcode (0x%x).\n"
+		"This means one of the following:\n"
+		"* The emulated GPU got desynced, disabling dual core can help\n"
+		"* Command stream corrupted by some spurious memory bug\n"
+		"* This really is an unknown opcode (unlikely)\n"
+		"* Some other sort of bug\n\n"
+		"Dolphin will now likely crash or hang. Enjoy." , cmd_byte);
+	Host_SysMessage(temp.c_str());
+	INFO_LOG(VIDEO, "%s", temp.c_str());
 	{
-	case GX_NOP: // Hm, this means that we scan over nop streams pretty slowly...
-		command_size = 1;
-		cycleTime = 6;
-		break;
-	case GX_CMD_INVL_VC: // Invalidate Vertex Cache - no parameters
-		command_size = 1;
-		cycleTime = 6;
-		break;
-	case GX_CMD_UNKNOWN_METRICS: // zelda 4 swords calls it and checks the metrics registers after that
-		command_size = 1;
-		cycleTime = 6;
-		break;
-
-	case GX_LOAD_BP_REG:
-		command_size = 5;
-		cycleTime = 12;
-		break;
-
-	case GX_LOAD_CP_REG:
-		command_size = 6;
-		cycleTime = 12;
-		break;
-
-	case GX_LOAD_INDX_A:
-	case GX_LOAD_INDX_B:
-	case GX_LOAD_INDX_C:
-	case GX_LOAD_INDX_D:
-		command_size = 5;
-		cycleTime = 6; // TODO
-		break;
-
-	case GX_CMD_CALL_DL:
-		{
-			// FIXME: Calculate the cycle time of the display list.
-			//u32 address = DataPeek32(1);
-			//u32 size = DataPeek32(5);
-			//u8* old_pVideoData = g_pVideoData;
-			//u8* startAddress = Memory::GetPointer(address);
-
-			//// Avoid the crash if Memory::GetPointer failed ..
-			//if (startAddress != 0)
-			//{
-			//	g_pVideoData = startAddress;
-			//	u8 *end = g_pVideoData + size;
-			//	u32 step = 0;
-			//	while (g_pVideoData < end)
-			//	{
-			//		cycleTime += FifoCommandRunnable(step);
-			//		g_pVideoData += step;
-			//	}
-			//}
-			//else
-			//{
-			//	cycleTime = 45;
-			//}
-
-			//// reset to the old pointer
-			//g_pVideoData = old_pVideoData;
-			command_size = 9;
-			cycleTime = 45;  // This is unverified
-		}
-		break;
-
-	case GX_LOAD_XF_REG:
-		{
-			// check if we can read the header
-			if (buffer_size >= 5)
-			{
-				command_size = 1 + 4;
-				u32 Cmd2 = DataPeek32(1);
-				int transfer_size = ((Cmd2 >> 16) & 15) + 1;
-				command_size += transfer_size * 4;
-				cycleTime = 18 + 6 * transfer_size;
-			}
-			else
-			{
-				return 0;
-			}
-		}
-		break;
-
-	default:
-		if ((cmd_byte & 0xC0) == 0x80)
-		{
-			// check if we can read the header
-			if (buffer_size >= 3)
-			{
-				command_size = 1 + 2;
-				u16 numVertices = DataPeek16(1);
-				command_size += numVertices * VertexLoaderManager::GetVertexSize(cmd_byte & GX_VAT_MASK);
-				cycleTime = 1600; // This depends on the number of pixels rendered
-			}
-			else
-			{
-				return 0;
-			}
-		}
-		else
-		{
-			// TODO(Omega): Maybe dump FIFO to file on this error
-			std::string temp = StringFromFormat(
-				"GFX FIFO: Unknown Opcode (0x%x).\n"
-				"This means one of the following:\n"
-				"* The emulated GPU got desynced, disabling dual core can help\n"
-				"* Command stream corrupted by some spurious memory bug\n"
-				"* This really is an unknown opcode (unlikely)\n"
-				"* Some other sort of bug\n\n"
-				"Dolphin will now likely crash or hang. Enjoy." , cmd_byte);
-			Host_SysMessage(temp.c_str());
-			INFO_LOG(VIDEO, "%s", temp.c_str());
-			{
-				SCPFifoStruct &fifo = CommandProcessor::fifo;
-
-				std::string tmp = StringFromFormat(
-					"Illegal command %02x\n"
-					"CPBase: 0x%08x\n"
-					"CPEnd: 0x%08x\n"
-					"CPHiWatermark: 0x%08x\n"
-					"CPLoWatermark: 0x%08x\n"
-					"CPReadWriteDistance: 0x%08x\n"
-					"CPWritePointer: 0x%08x\n"
-					"CPReadPointer: 0x%08x\n"
-					"CPBreakpoint: 0x%08x\n"
-					"bFF_GPReadEnable: %s\n"
-					"bFF_BPEnable: %s\n"
-					"bFF_BPInt: %s\n"
-					"bFF_Breakpoint: %s\n"
-					,cmd_byte, fifo.CPBase, fifo.CPEnd, fifo.CPHiWatermark, fifo.CPLoWatermark, fifo.CPReadWriteDistance
-					,fifo.CPWritePointer, fifo.CPReadPointer, fifo.CPBreakpoint, fifo.bFF_GPReadEnable ? "true" : "false"
-					,fifo.bFF_BPEnable ? "true" : "false" ,fifo.bFF_BPInt ? "true" : "false"
-					,fifo.bFF_Breakpoint ? "true" : "false");
-
-				Host_SysMessage(tmp.c_str());
-				INFO_LOG(VIDEO, "%s", tmp.c_str());
-			}
-		}
-		break;
+		SCPFifoStruct &fifo = CommandProcessor::fifo;
+
+		std::string tmp = StringFromFormat(
+			"Illegal command %02x\n"
+			"CPBase: 0x%08x\n"
+			"CPEnd: 0x%08x\n"
+			"CPHiWatermark: 0x%08x\n"
+			"CPLoWatermark: 0x%08x\n"
+			"CPReadWriteDistance: 0x%08x\n"
+			"CPWritePointer: 0x%08x\n"
+			"CPReadPointer: 0x%08x\n"
+			"CPBreakpoint: 0x%08x\n"
+			"bFF_GPReadEnable: %s\n"
+			"bFF_BPEnable: %s\n"
+			"bFF_BPInt: %s\n"
+			"bFF_Breakpoint: %s\n"
+			,cmd_byte, fifo.CPBase, fifo.CPEnd, fifo.CPHiWatermark, fifo.CPLoWatermark, fifo.CPReadWriteDistance
+			,fifo.CPWritePointer, fifo.CPReadPointer, fifo.CPBreakpoint, fifo.bFF_GPReadEnable ? "true" : "false"
+			,fifo.bFF_BPEnable ? "true" : "false" ,fifo.bFF_BPInt ? "true" : "false"
+			,fifo.bFF_Breakpoint ? "true" : "false");
+
+		Host_SysMessage(tmp.c_str());
+		INFO_LOG(VIDEO, "%s", tmp.c_str());
 	}
-
-	if (command_size > buffer_size)
-		return 0;
-
-	// INFO_LOG("OP detected: cmd_byte 0x%x  size %i  buffer %i",cmd_byte, command_size, buffer_size);
-	if (cycleTime == 0)
-		cycleTime = 6;
-
-	return cycleTime;
 }
 
-static u32 FifoCommandRunnable()
-{
-	u32 command_size = 0;
-	return FifoCommandRunnable(command_size);
-}
-
-static void Decode()
+// Decodes the command at g_pVideoData in a single pass, checking as it goes
+// that the command ends before end. Returns the number of cycles the command
+// takes, or 0 if it isn't complete yet, in which case g_pVideoData is left
+// at its start so that it can be decoded again once more data arrived.
+// Skipped frames only let through what's needed to keep the GPU state right.
+template <bool is_skipped_frame>
+static u32 Decode(u8* end)
 {
 	u8 *opcodeStart = g_pVideoData;
+	if (opcodeStart == end)
+		return 0;
 
+	const u32 available = (u32)(end - opcodeStart);
+	u32 cycles;
 	int cmd_byte = DataReadU8();
 	switch (cmd_byte)
 	{
 	case GX_NOP:
+		cycles = 6;
 		break;
 
 	case GX_LOAD_CP_REG: //0x08
+		// We have to let CP writes through on skipped frames because they determine the size of vertices.
 		{
+			if (available < 6)
+				goto incomplete;
 			u8 sub_cmd = DataReadU8();
 			u32 value = DataReadU32();
 			LoadCPReg(sub_cmd, value);
 			INCSTAT(stats.thisFrame.numCPLoads);
+			cycles = 12;
 		}
 		break;
 
 	case GX_LOAD_XF_REG:
 		{
-			u32 Cmd2 = DataReadU32();
+			if (available < 5)
+				goto incomplete;
+			u32 Cmd2 = DataPeek32(0);
 			int transfer_size = ((Cmd2 >> 16) & 15) + 1;
+			if (available < 5 + transfer_size * 4u)
+				goto incomplete;
+			DataSkip(4);
 			u32 xf_address = Cmd2 & 0xFFFF;
 			GC_ALIGNED128(u32 data_buffer[16]);
 			DataReadU32xFuncs[transfer_size-1](data_buffer);
 			LoadXFReg(transfer_size, xf_address, data_buffer);
 
 			INCSTAT(stats.thisFrame.numXFLoads);
+			cycles = 18 + 6 * transfer_size;
 		}
 		break;
 
 	case GX_LOAD_INDX_A: //used for position matrices
-		LoadIndexedXF(DataReadU32(), 0xC);
-		break;
 	case GX_LOAD_INDX_B: //used for normal matrices
-		LoadIndexedXF(DataReadU32(), 0xD);
-		break;
 	case GX_LOAD_INDX_C: //used for postmatrices
-		LoadIndexedXF(DataReadU32(), 0xE);
-		break;
 	case GX_LOAD_INDX_D: //used for lights
-		LoadIndexedXF(DataReadU32(), 0xF);
+		if (available < 5)
+			goto incomplete;
+		// 0x20 -> 0xC, 0x28 -> 0xD, 0x30 -> 0xE, 0x38 -> 0xF
+		LoadIndexedXF(DataReadU32(), 0xC + ((cmd_byte - GX_LOAD_INDX_A) >> 3));
+		cycles = 6; // TODO
 		break;
 
 	case GX_CMD_CALL_DL:
 		{
+			if (available < 9)
+				goto incomplete;
 			u32 address = DataReadU32();
 			u32 count = DataReadU32();
-			InterpretDisplayList(address, count);
+			if (!is_skipped_frame)
+				InterpretDisplayList(address, count);
+			// Hm, wonder if any games put tokens in display lists - in that case,
+			// we'll have to parse them too.
+			else if (g_use_deterministic_gpu_thread)
+				InterpretDisplayListSemiNop();
+			cycles = 45;  // This is unverified
 		}
 		break;
 
 	case GX_CMD_UNKNOWN_METRICS: // zelda 4 swords calls it and checks the metrics registers after that
 		DEBUG_LOG(VIDEO, "GX 0x44: %08x", cmd_byte);
+		cycles = 6;
 		break;
 
 	case GX_CMD_INVL_VC: // Invalidate Vertex Cache
 		DEBUG_LOG(VIDEO, "Invalidate (vertex cache?)");
+		cycles = 6;
 		break;
 
 	case GX_LOAD_BP_REG: //0x61
+		// We have to let BP writes through on skipped frames because they set tokens and stuff.
+		// TODO: Call a much simplified LoadBPReg instead.
 		{
+			if (available < 5)
+				goto incomplete;
 			u32 bp_cmd = DataReadU32();
 			LoadBPReg(bp_cmd);
 			INCSTAT(stats.thisFrame.numBPLoads);
+			cycles = 12;
 		}
 		break;
 
@@ -344,108 +305,48 @@ static void Decode()
 	default:
 		if ((cmd_byte & 0xC0) == 0x80)
 		{
-			// load vertices (use computed vertex size from FifoCommandRunnable above)
-			u16 numVertices = DataReadU16();
-
-			VertexLoaderManager::RunVertices(
-				cmd_byte & GX_VAT_MASK,   // Vertex loader index (0 - 7)
-				(cmd_byte & GX_PRIMITIVE_MASK) >> GX_PRIMITIVE_SHIFT,
-				numVertices);
+			if (available < 3)
+				goto incomplete;
+			u16 numVertices = DataPeek16(0);
+			const int vtx_attr_group = cmd_byte & GX_VAT_MASK;
+			if (available < 3 + numVertices * (u32)VertexLoaderManager::GetVertexSize(vtx_attr_group))
+				goto incomplete;
+			DataSkip(2);
+
+			if (is_skipped_frame)
+			{
+				VertexLoaderManager::SkipVertices(vtx_attr_group, numVertices);
+			}
+			else
+			{
+				VertexLoaderManager::RunVertices(
+					vtx_attr_group,   // Vertex loader index (0 - 7)
+					(cmd_byte & GX_PRIMITIVE_MASK) >> GX_PRIMITIVE_SHIFT,
+					numVertices);
+			}
+			cycles = 1600; // This depends on the number of pixels rendered
 		}
 		else
 		{
+			if (!s_in_display_list)
+				UnknownOpcode(cmd_byte);
 			ERROR_LOG(VIDEO, "OpcodeDecoding::Decode: Illegal command %02x", cmd_byte);
-			break;
+			cycles = 6;
 		}
 		break;
 	}
 
+	INCSTAT(stats.thisFrame.numCommandsDecoded);
+
 	// Display lists get added directly into the FIFO stream
 	if (g_bRecordFifoData && cmd_byte != GX_CMD_CALL_DL)
 		FifoRecorder::GetInstance().WriteGPCommand(opcodeStart, u32(g_pVideoData - opcodeStart));
-}
-
-static void DecodeSemiNop()
-{
-	u8 *opcodeStart = g_pVideoData;
-
-	int cmd_byte = DataReadU8();
-	switch (cmd_byte)
-	{
-	case GX_CMD_UNKNOWN_METRICS: // zelda 4 swords calls it and checks the metrics registers after that
-	case GX_CMD_INVL_VC: // Invalidate Vertex Cache
-	case GX_NOP:
-		break;
-
-	case GX_LOAD_CP_REG: //0x08
-		// We have to let CP writes through because they determine the size of vertices.
-		{
-			u8 sub_cmd = DataReadU8();
-			u32 value = DataReadU32();
-			LoadCPReg(sub_cmd, value);
-			INCSTAT(stats.thisFrame.numCPLoads);
-		}
-		break;
-
-	case GX_LOAD_XF_REG:
-		{
-			u32 Cmd2 = DataReadU32();
-			int transfer_size = ((Cmd2 >> 16) & 15) + 1;
-			u32 address = Cmd2 & 0xFFFF;
-			GC_ALIGNED128(u32 data_buffer[16]);
-			DataReadU32xFuncs[transfer_size-1](data_buffer);
-			LoadXFReg(transfer_size, address, data_buffer);
-			INCSTAT(stats.thisFrame.numXFLoads);
-		}
-		break;
 
-	case GX_LOAD_INDX_A: //used for position matrices
-		LoadIndexedXF(DataReadU32(), 0xC);
-		break;
-	case GX_LOAD_INDX_B: //used for normal matrices
-		LoadIndexedXF(DataReadU32(), 0xD);
-		break;
-	case GX_LOAD_INDX_C: //used for postmatrices
-		LoadIndexedXF(DataReadU32(), 0xE);
-		break;
-	case GX_LOAD_INDX_D: //used for lights
-		LoadIndexedXF(DataReadU32(), 0xF);
-		break;
-
-	case GX_CMD_CALL_DL:
-		// Hm, wonder if any games put tokens in display lists - in that case,
-		// we'll have to parse them too.
-		DataSkip(8);
-		break;
-
-	case GX_LOAD_BP_REG: //0x61
-		// We have to let BP writes through because they set tokens and stuff.
-		// TODO: Call a much simplified LoadBPReg instead.
-		{
-			u32 bp_cmd = DataReadU32();
-			LoadBPReg(bp_cmd);
-			INCSTAT(stats.thisFrame.numBPLoads);
-		}
-		break;
-
-	// draw primitives
-	default:
-		if ((cmd_byte & 0xC0) == 0x80)
-		{
-			// load vertices (use computed vertex size from FifoCommandRunnable above)
-			u16 numVertices = DataReadU16();
-			DataSkip(numVertices * VertexLoaderManager::GetVertexSize(cmd_byte & GX_VAT_MASK));
-		}
-		else
-		{
-			ERROR_LOG(VIDEO, "OpcodeDecoding::Decode: Illegal command %02x", cmd_byte);
-			break;
-		}
-		break;
-	}
+	return cycles;
 
-	if (g_bRecordFifoData && cmd_byte != GX_CMD_CALL_DL)
-		FifoRecorder::GetInstance().WriteGPCommand(opcodeStart, u32(g_pVideoData - opcodeStart));
+incomplete:
+	g_pVideoData = opcodeStart;
+	return 0;
 }
 
 void OpcodeDecoder_Init()
@@ -464,17 +365,125 @@ void OpcodeDecoder_Init()
 
 void OpcodeDecoder_Shutdown()
 {
+	DisplayListCache::Shutdown();
 }
 
 u32 OpcodeDecoder_Run(bool skipped_frame)
 {
+	u8* end = GetVideoBufferEndPtr();
 	u32 totalCycles = 0;
-	u32 cycles = FifoCommandRunnable();
-	while (cycles > 0)
+	while (true)
 	{
-		skipped_frame ? DecodeSemiNop() : Decode();
+		u32 cycles = skipped_frame ? Decode<true>(end) : Decode<false>(end);
+		if (!cycles)
+			break;
 		totalCycles += cycles;
-		cycles = FifoCommandRunnable();
 	}
 	return totalCycles;
 }
+
+// Runs on the CPU thread ahead of the deterministic GPU thread: tracks the CP
+// registers that determine command sizes, fires PE tokens/draw-done, and copies
+// whatever RAM the commands reference (display lists, vertex arrays, indexed XF
+// loads) into the aux buffer, in the order Decode() will consume it.
+// Returns a pointer to the first command that isn't complete yet.
+static u8* Preprocess(u8* src, u8* end, bool* sync_needed)
+{
+	while (src < end)
+	{
+		u8* cmd_start = src;
+		u32 available = (u32)(end - src);
+		u8 cmd_byte = *src++;
+		switch (cmd_byte)
+		{
+		case GX_NOP:
+		case GX_CMD_UNKNOWN_METRICS:
+		case GX_CMD_INVL_VC:
+			break;
+
+		case GX_LOAD_CP_REG:
+			if (available < 6)
+				return cmd_start;
+			LoadCPRegPreprocess(src[0], Common::swap32(src + 1));
+			src += 5;
+			break;
+
+		case GX_LOAD_XF_REG:
+			{
+				if (available < 5)
+					return cmd_start;
+				u32 transfer_size = ((Common::swap32(src) >> 16) & 15) + 1;
+				if (available < 5 + transfer_size * 4)
+					return cmd_start;
+				src += 4 + transfer_size * 4;
+			}
+			break;
+
+		case GX_LOAD_INDX_A:
+		case GX_LOAD_INDX_B:
+		case GX_LOAD_INDX_C:
+		case GX_LOAD_INDX_D:
+			if (available < 5)
+				return cmd_start;
+			// 0x20 -> 0xC, 0x28 -> 0xD, 0x30 -> 0xE, 0x38 -> 0xF
+			PreprocessIndexedXF(Common::swap32(src), 0xC + ((cmd_byte - GX_LOAD_INDX_A) >> 3));
+			src += 4;
+			break;
+
+		case GX_CMD_CALL_DL:
+			{
+				if (available < 9)
+					return cmd_start;
+				u32 address = Common::swap32(src);
+				u32 size = Common::swap32(src + 4);
+				src += 8;
+
+				u8* dl_start = Memory::GetPointer(address);
+				if (dl_start == nullptr || Memory::GetPointer(address + size - 1) != dl_start + size - 1)
+					size = 0;
+
+				PushFifoAuxBuffer(&size, sizeof(u32));
+				PushFifoAuxBuffer(dl_start, size);
+				if (size)
+					Preprocess(dl_start, dl_start + size, sync_needed);
+			}
+			break;
+
+		case GX_LOAD_BP_REG:
+			if (available < 5)
+				return cmd_start;
+			if (LoadBPRegPreprocess(Common::swap32(src)))
+				*sync_needed = true;
+			src += 4;
+			break;
+
+		default:
+			if ((cmd_byte & 0xC0) == 0x80)
+			{
+				if (available < 3)
+					return cmd_start;
+				int vtx_attr_group = cmd_byte & GX_VAT_MASK;
+				u16 num_vertices = Common::swap16(src);
+				u32 vertex_size = VertexLoaderManager::GetPreprocessVertexSize(vtx_attr_group);
+				if (available < 3 + num_vertices * vertex_size)
+					return cmd_start;
+				src += 2;
+				VertexLoaderManager::PreprocessVertices(vtx_attr_group, src, num_vertices);
+				src += num_vertices * vertex_size;
+			}
+			else
+			{
+				// The GPU thread reports this properly when it gets there.
+				ERROR_LOG(VIDEO, "OpcodeDecoder_Preprocess: Illegal command %02x", cmd_byte);
+			}
+			break;
+		}
+	}
+
+	return src;
+}
+
+u8* OpcodeDecoder_Preprocess(u8* start, u8* end, bool* sync_needed)
+{
+	return Preprocess(start, end, sync_needed);
+}
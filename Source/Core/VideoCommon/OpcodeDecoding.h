@@ -39,4 +39,5 @@ extern bool g_bRecordFifoData;
 void OpcodeDecoder_Init();
 void OpcodeDecoder_Shutdown();
 u32 OpcodeDecoder_Run(bool skipped_frame);
+u8* OpcodeDecoder_Preprocess(u8* start, u8* end, bool* sync_needed);
 void InterpretDisplayList(u32 address, u32 size);
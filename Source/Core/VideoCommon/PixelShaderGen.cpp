@@ -138,7 +138,7 @@ static const char *tevRasTable[] =
 static const char *tevCOutputTable[]  = { "prev.rgb", "c0.rgb", "c1.rgb", "c2.rgb" };
 static const char *tevAOutputTable[]  = { "prev.a", "c0.a", "c1.a", "c2.a" };
 
-static char text[16384];
+static char text[32768];
 
 template<class T> static inline void WriteStage(T& out, pixel_shader_uid_data& uid_data, int n, API_TYPE ApiType, const char swapModeTable[4][5]);
 template<class T> static inline void WriteTevRegular(T& out, const char* components, int bias, int op, int clamp, int shift);
@@ -154,7 +154,7 @@ static inline void GeneratePixelShader(T& out, DSTALPHA_MODE dstAlphaMode, API_T
 	pixel_shader_uid_data& uid_data = (&out.template GetUidData<pixel_shader_uid_data>() != nullptr)
 										? out.template GetUidData<pixel_shader_uid_data>() : dummy_data;
 
-	out.SetBuffer(text);
+	out.SetBuffer(text, sizeof(text));
 	const bool is_writing_shadercode = (out.GetBuffer() != nullptr);
 #ifndef ANDROID
 	locale_t locale;
@@ -166,9 +166,6 @@ static inline void GeneratePixelShader(T& out, DSTALPHA_MODE dstAlphaMode, API_T
 	}
 #endif
 
-	if (is_writing_shadercode)
-		text[sizeof(text) - 1] = 0x7C;  // canary
-
 	unsigned int numStages = bpmem.genMode.numtevstages + 1;
 	unsigned int numTexgen = bpmem.genMode.numtexgens;
 
@@ -554,8 +551,8 @@ static inline void GeneratePixelShader(T& out, DSTALPHA_MODE dstAlphaMode, API_T
 
 	if (is_writing_shadercode)
 	{
-		if (text[sizeof(text) - 1] != 0x7C)
-			PanicAlert("PixelShader generator - buffer too small, canary has been eaten!");
+		if (out.HasOverflowed())
+			PanicAlert("PixelShader generator - buffer too small, the shader has been cut off!");
 
 #ifndef ANDROID
 		uselocale(old_locale); // restore locale
@@ -1055,6 +1052,7 @@ static inline void WriteFog(T& out, pixel_shader_uid_data& uid_data)
 void GetPixelShaderUid(PixelShaderUid& object, DSTALPHA_MODE dstAlphaMode, API_TYPE ApiType, u32 components)
 {
 	GeneratePixelShader<PixelShaderUid>(object, dstAlphaMode, ApiType, components);
+	object.CalculateHash();
 }
 
 void GeneratePixelShaderCode(PixelShaderCode& object, DSTALPHA_MODE dstAlphaMode, API_TYPE ApiType, u32 components)
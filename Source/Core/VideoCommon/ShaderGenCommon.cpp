@@ -0,0 +1,101 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+#include "VideoCommon/ShaderGenCommon.h"
+
+void ShaderCode::Write(const char* fmt, ...)
+{
+	va_list arglist;
+	va_start(arglist, fmt);
+
+	const char* p = fmt;
+	while (true)
+	{
+		const char* percent = strchr(p, '%');
+		if (!percent)
+		{
+			Append(p, strlen(p));
+			break;
+		}
+
+		Append(p, percent - p);
+		p = percent + 2;
+		switch (percent[1])
+		{
+		case 'd':
+		case 'i':
+			AppendInt(va_arg(arglist, int));
+			continue;
+
+		case 'u':
+			AppendUInt(va_arg(arglist, unsigned int));
+			continue;
+
+		case 's':
+			{
+				const char* str = va_arg(arglist, const char*);
+				Append(str, strlen(str));
+			}
+			continue;
+
+		case 'c':
+			{
+				char c = (char)va_arg(arglist, int);
+				Append(&c, 1);
+			}
+			continue;
+
+		case '%':
+			Append("%", 1);
+			continue;
+		}
+
+		// Flags, widths and other conversions: leave the rest of the string to vsnprintf
+		const size_t space = end_ptr - write_ptr + 1;
+		int length = vsnprintf(write_ptr, space, percent, arglist);
+		if (length < 0 || (size_t)length >= space)
+		{
+			write_ptr = end_ptr;
+			*write_ptr = '\0';
+			overflowed = true;
+		}
+		else
+		{
+			write_ptr += length;
+		}
+		break;
+	}
+
+	va_end(arglist);
+}
+
+void ShaderCode::AppendInt(int value)
+{
+	if (value < 0)
+	{
+		Append("-", 1);
+		// Negate as unsigned so that INT_MIN works
+		AppendUInt(0u - (unsigned int)value);
+	}
+	else
+	{
+		AppendUInt(value);
+	}
+}
+
+void ShaderCode::AppendUInt(unsigned int value)
+{
+	char digits[10];
+	char* p = digits + sizeof(digits);
+	do
+	{
+		*--p = '0' + value % 10;
+		value /= 10;
+	} while (value);
+	Append(p, digits + sizeof(digits) - p);
+}
@@ -7,11 +7,13 @@
 #include <algorithm>
 #include <cstdarg>
 #include <cstdio>
+#include <cstring>
 #include <iomanip>
 #include <string>
 #include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Common/Hash.h"
 #include "Common/StringUtil.h"
 #include "VideoCommon/VideoCommon.h"
 
@@ -42,8 +44,14 @@ public:
 	/*
 	 * Can be used to give the object a place to write to. This should be called before using Write().
 	 * @param buffer pointer to a char buffer that the object can write to
+	 * @param size size of the buffer, including space for the null terminator
 	 */
-	void SetBuffer(char* buffer) { }
+	void SetBuffer(char* buffer, size_t size) { }
+
+	/*
+	 * Returns true if the code didn't fit into the buffer and was cut off.
+	 */
+	bool HasOverflowed() const { return false; }
 
 	/*
 	 * Tells us that a specific constant range (including last_index) is being used by the shader
@@ -63,25 +71,41 @@ public:
  * uid_data can be any struct of parameters that uniquely identify each shader code output.
  * Unless performance is not an issue, uid_data should be tightly packed to reduce memory footprint.
  * Shader generators will write to specific uid_data fields; ShaderUid methods will only read raw u32 values from a union.
+ * Once the generator is done, CalculateHash() must be called before the uid is compared or used as a key.
  */
 template<class uid_data>
 class ShaderUid : public ShaderGeneratorInterface
 {
 public:
-	ShaderUid()
+	ShaderUid() : hash(0)
 	{
 		// TODO: Move to Shadergen => can be optimized out
 		memset(values, 0, sizeof(values));
 	}
 
+	// The hash isn't meant to be persistent: call this again on uids read from disk.
+	void CalculateHash()
+	{
+		hash = GetMurmurHash3(values, data.NumValues() * sizeof(*values), 0);
+	}
+
+	u64 GetHash() const { return hash; }
+
+	// Uses the cached hash, for unordered containers
+	struct Hasher
+	{
+		size_t operator()(const ShaderUid& uid) const { return (size_t)uid.hash; }
+	};
+
+	// Most uids differ in their hash already, which saves the memcmp
 	bool operator == (const ShaderUid& obj) const
 	{
-		return memcmp(this->values, obj.values, data.NumValues() * sizeof(*values)) == 0;
+		return hash == obj.hash && memcmp(this->values, obj.values, data.NumValues() * sizeof(*values)) == 0;
 	}
 
 	bool operator != (const ShaderUid& obj) const
 	{
-		return memcmp(this->values, obj.values, data.NumValues() * sizeof(*values)) != 0;
+		return !(*this == obj);
 	}
 
 	// determines the storage order inside STL containers
@@ -102,30 +126,51 @@ private:
 		uid_data data;
 		u8 values[sizeof(uid_data)];
 	};
+	u64 hash;
 };
 
 class ShaderCode : public ShaderGeneratorInterface
 {
 public:
-	ShaderCode() : buf(nullptr), write_ptr(nullptr)
+	ShaderCode() : buf(nullptr), write_ptr(nullptr), end_ptr(nullptr), overflowed(false)
 	{
 
 	}
 
-	void Write(const char* fmt, ...)
-	{
-		va_list arglist;
-		va_start(arglist, fmt);
-		write_ptr += vsprintf(write_ptr, fmt, arglist);
-		va_end(arglist);
-	}
+	// %d, %i, %u, %s, %c and %% are formatted directly, which is all the shader
+	// generators use in practice. Anything else is handed to vsnprintf.
+	void Write(const char* fmt, ...);
 
 	const char* GetBuffer() { return buf; }
-	void SetBuffer(char* buffer) { buf = buffer; write_ptr = buffer; }
+	void SetBuffer(char* buffer, size_t size)
+	{
+		buf = buffer;
+		write_ptr = buffer;
+		end_ptr = buffer + size - 1;
+		overflowed = false;
+		*write_ptr = '\0';
+	}
+	bool HasOverflowed() const { return overflowed; }
 
 private:
+	void Append(const char* str, size_t length)
+	{
+		if (length > (size_t)(end_ptr - write_ptr))
+		{
+			length = end_ptr - write_ptr;
+			overflowed = true;
+		}
+		memcpy(write_ptr, str, length);
+		write_ptr += length;
+		*write_ptr = '\0';
+	}
+	void AppendInt(int value);
+	void AppendUInt(unsigned int value);
+
 	const char* buf;
 	char* write_ptr;
+	char* end_ptr; // where the null terminator goes when the buffer is full
+	bool overflowed;
 };
 
 /**
@@ -35,8 +35,11 @@ std::string Statistics::ToString()
 	str += StringFromFormat("vshaders alive: %i\n", stats.numVertexShadersAlive);
 	str += StringFromFormat("shaders changes: %i\n", stats.thisFrame.numShaderChanges);
 	str += StringFromFormat("dlists called: %i\n", stats.thisFrame.numDListsCalled);
+	str += StringFromFormat("GX commands decoded: %i\n", stats.thisFrame.numCommandsDecoded);
 	str += StringFromFormat("Primitive joins: %i\n", stats.thisFrame.numPrimitiveJoins);
 	str += StringFromFormat("Draw calls: %i\n", stats.thisFrame.numDrawCalls);
+	str += StringFromFormat("Draw calls skipped: %i\n", stats.thisFrame.numDrawCallsSkipped);
+	str += StringFromFormat("Flushes avoided: %i\n", stats.thisFrame.numFlushesAvoided);
 	str += StringFromFormat("Primitives: %i\n", stats.thisFrame.numPrims);
 	str += StringFromFormat("Primitives (DL): %i\n", stats.thisFrame.numDLPrims);
 	str += StringFromFormat("XF loads: %i\n", stats.thisFrame.numXFLoads);
@@ -48,6 +51,7 @@ std::string Statistics::ToString()
 	str += StringFromFormat("Vertex streamed: %i kB\n", stats.thisFrame.bytesVertexStreamed/1024);
 	str += StringFromFormat("Index streamed: %i kB\n", stats.thisFrame.bytesIndexStreamed/1024);
 	str += StringFromFormat("Uniform streamed: %i kB\n", stats.thisFrame.bytesUniformStreamed/1024);
+	str += StringFromFormat("Stream buffer stalls: %i (%i us)\n", stats.thisFrame.numStreamBufferStalls, stats.thisFrame.usStreamBufferStalled);
 	str += StringFromFormat("Vertex Loaders: %i\n", stats.numVertexLoaders);
 
 	std::string vertex_list;
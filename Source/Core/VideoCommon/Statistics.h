@@ -47,12 +47,17 @@ struct Statistics
 
 		int numPrimitiveJoins;
 		int numDrawCalls;
+		int numDrawCallsSkipped; // waiting for their shaders to be compiled
+		int numFlushesAvoided; // XF memory loads that didn't affect the pending vertices
 
 		int numDListsCalled;
+		int numCommandsDecoded;
 
 		int bytesVertexStreamed;
 		int bytesIndexStreamed;
 		int bytesUniformStreamed;
+		int numStreamBufferStalls; // waits for the gpu to free up stream buffer space
+		int usStreamBufferStalled;
 	};
 	ThisFrame thisFrame;
 	void ResetFrame();
@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <string>
+#include <vector>
 
 #include "Common/FileUtil.h"
 #include "Common/MemoryUtil.h"
@@ -22,6 +23,7 @@
 enum
 {
 	TEXTURE_KILL_THRESHOLD = 200,
+	TEXTURE_POOL_KILL_THRESHOLD = 3,
 };
 
 TextureCache *g_texture_cache;
@@ -30,6 +32,7 @@ GC_ALIGNED16(u8 *TextureCache::temp) = nullptr;
 unsigned int TextureCache::temp_size;
 
 TextureCache::TexCache TextureCache::textures;
+TextureCache::TexPool TextureCache::texture_pool;
 
 TextureCache::BackupConfig TextureCache::backup_config;
 
@@ -67,6 +70,12 @@ void TextureCache::Invalidate()
 		delete tex.second;
 	}
 	textures.clear();
+
+	for (auto& tex : texture_pool)
+	{
+		delete tex.second;
+	}
+	texture_pool.clear();
 }
 
 TextureCache::~TextureCache()
@@ -130,7 +139,7 @@ void TextureCache::Cleanup()
             // EFB copies living on the host GPU are unrecoverable and thus shouldn't be deleted
 		    !iter->second->IsEfbCopy())
 		{
-			delete iter->second;
+			FreeTexture(iter->second);
 			textures.erase(iter++);
 		}
 		else
@@ -138,6 +147,23 @@ void TextureCache::Cleanup()
 			++iter;
 		}
 	}
+
+	// Pooled textures are only kept around for a few frames, enough to be picked up by
+	// games which stream a new texture of the same size each frame.
+	TexPool::iterator pool_iter = texture_pool.begin();
+	TexPool::iterator pool_end = texture_pool.end();
+	while (pool_iter != pool_end)
+	{
+		if (frameCount > TEXTURE_POOL_KILL_THRESHOLD + pool_iter->second->frameCount)
+		{
+			delete pool_iter->second;
+			texture_pool.erase(pool_iter++);
+		}
+		else
+		{
+			++pool_iter;
+		}
+	}
 }
 
 void TextureCache::InvalidateRange(u32 start_address, u32 size)
@@ -150,7 +176,7 @@ void TextureCache::InvalidateRange(u32 start_address, u32 size)
 		const int rangePosition = iter->second->IntersectsMemoryRange(start_address, size);
 		if (0 == rangePosition)
 		{
-			delete iter->second;
+			FreeTexture(iter->second);
 			textures.erase(iter++);
 		}
 		else
@@ -162,28 +188,21 @@ void TextureCache::InvalidateRange(u32 start_address, u32 size)
 
 void TextureCache::MakeRangeDynamic(u32 start_address, u32 size)
 {
-	TexCache::iterator
-		iter = textures.lower_bound(start_address),
-		tcend = textures.upper_bound(start_address + size);
-
-	if (iter != textures.begin())
-		--iter;
-
-	for (; iter != tcend; ++iter)
+	for (auto& tex : textures)
 	{
-		const int rangePosition = iter->second->IntersectsMemoryRange(start_address, size);
+		const int rangePosition = tex.second->IntersectsMemoryRange(start_address, size);
 		if (0 == rangePosition)
 		{
-			iter->second->SetHashes(TEXHASH_INVALID);
+			tex.second->SetHashes(TEXHASH_INVALID);
 		}
 	}
 }
 
 bool TextureCache::Find(u32 start_address, u64 hash)
 {
-	TexCache::iterator iter = textures.lower_bound(start_address);
+	TexCache::iterator iter = textures.find(start_address);
 
-	if (iter->second->hash == hash)
+	if (iter != textures.end() && iter->second->hash == hash)
 		return true;
 
 	return false;
@@ -210,7 +229,7 @@ void TextureCache::ClearRenderTargets()
 	{
 		if (iter->second->type == TCET_EC_VRAM)
 		{
-			delete iter->second;
+			FreeTexture(iter->second);
 			textures.erase(iter++);
 		}
 		else
@@ -317,6 +336,46 @@ static u32 CalculateLevelSize(u32 level_0_size, u32 level)
 }
 
 // Used by TextureCache::Load
+static u64 GetPoolKey(unsigned int width, unsigned int height, unsigned int tex_levels, PC_TexFormat pcfmt)
+{
+	return (u64)width | ((u64)height << 16) | ((u64)tex_levels << 32) | ((u64)(pcfmt + 1) << 40);
+}
+
+TextureCache::TCacheEntryBase* TextureCache::AllocateTexture(unsigned int width, unsigned int height,
+	unsigned int expanded_width, unsigned int tex_levels, PC_TexFormat pcfmt)
+{
+	const u64 pool_key = GetPoolKey(width, height, tex_levels, pcfmt);
+
+	TCacheEntryBase* entry;
+	TexPool::iterator iter = texture_pool.find(pool_key);
+	if (iter != texture_pool.end())
+	{
+		entry = iter->second;
+		texture_pool.erase(iter);
+		entry->Load(width, height, expanded_width, 0);
+	}
+	else
+	{
+		entry = g_texture_cache->CreateTexture(width, height, expanded_width, tex_levels, pcfmt);
+	}
+
+	entry->pool_key = pool_key;
+	return entry;
+}
+
+void TextureCache::FreeTexture(TCacheEntryBase* entry)
+{
+	// Render targets have no pool key, they're rarely freed and not worth recycling.
+	if (entry->pool_key == 0)
+	{
+		delete entry;
+		return;
+	}
+
+	entry->frameCount = frameCount;
+	texture_pool.insert(TexPool::value_type(entry->pool_key, entry));
+}
+
 static TextureCache::TCacheEntryBase* ReturnEntry(unsigned int stage, TextureCache::TCacheEntryBase* entry)
 {
 	entry->frameCount = frameCount;
@@ -432,8 +491,8 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 		}
 		else
 		{
-			// delete the texture and make a new one
-			delete entry;
+			// pool the texture and make a new one
+			FreeTexture(entry);
 			entry = nullptr;
 		}
 	}
@@ -454,7 +513,7 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 				// If we thought we could reuse the texture before, make sure to pool it now!
 				if (entry)
 				{
-					delete entry;
+					FreeTexture(entry);
 					entry = nullptr;
 				}
 			}
@@ -485,7 +544,7 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 	// create the entry/texture
 	if (nullptr == entry)
 	{
-		textures[texID] = entry = g_texture_cache->CreateTexture(width, height, expandedWidth, texLevels, pcfmt);
+		textures[texID] = entry = AllocateTexture(width, height, expandedWidth, texLevels, pcfmt);
 
 		// Sometimes, we can get around recreating a texture if only the number of mip levels changes
 		// e.g. if our texture cache entry got too many mipmap levels we can limit the number of used levels by setting the appropriate render states
@@ -533,20 +592,60 @@ TextureCache::TCacheEntryBase* TextureCache::Load(unsigned int const stage,
 				ptr_odd = &texMem[bpmem.tex[stage/4].texImage2[stage%4].tmem_odd * TMEM_LINE_SIZE];
 			}
 
-			for (; level != texLevels; ++level)
+			// Decode all levels before uploading any of them, so that they can be
+			// decoded in parallel. They are staged in the upper half of temp, then
+			// copied to its start one by one as entry->Load expects.
+			struct MipLevel
 			{
-				const u32 mip_width = CalculateLevelSize(width, level);
-				const u32 mip_height = CalculateLevelSize(height, level);
-				const u32 expanded_mip_width = (mip_width + bsw) & (~bsw);
-				const u32 expanded_mip_height = (mip_height + bsh) & (~bsh);
+				const u8* src;
+				u32 offset;
+				u32 width, height;
+				u32 expanded_width, expanded_height;
+			};
+			std::vector<MipLevel> mips;
+			u32 mips_size = 0;
+			for (u32 mip_level = 1; mip_level != texLevels; ++mip_level)
+			{
+				MipLevel mip;
+				mip.width = CalculateLevelSize(width, mip_level);
+				mip.height = CalculateLevelSize(height, mip_level);
+				mip.expanded_width = (mip.width + bsw) & (~bsw);
+				mip.expanded_height = (mip.height + bsh) & (~bsh);
 
 				const u8*& mip_src_data = from_tmem
-					? ((level % 2) ? ptr_odd : ptr_even)
+					? ((mip_level % 2) ? ptr_odd : ptr_even)
 					: src_data;
-				TexDecoder_Decode(temp, mip_src_data, expanded_mip_width, expanded_mip_height, texformat, tlutaddr, tlutfmt, g_ActiveConfig.backend_info.bUseRGBATextures);
-				mip_src_data += TexDecoder_GetTextureSizeInBytes(expanded_mip_width, expanded_mip_height, texformat);
+				mip.src = mip_src_data;
+				mip_src_data += TexDecoder_GetTextureSizeInBytes(mip.expanded_width, mip.expanded_height, texformat);
+
+				mip.offset = mips_size;
+				mips_size += (mip.expanded_width * mip.expanded_height * 4 + 15) & ~15;
+				mips.push_back(mip);
+			}
+
+			if (mips_size > temp_size / 2)
+			{
+				temp_size = mips_size * 2;
+				FreeAlignedMemory(temp);
+				temp = (u8*)AllocateAlignedMemory(temp_size, 16);
+			}
+			u8* const mips_data = temp + temp_size / 2;
+			const bool rgba_only = g_ActiveConfig.backend_info.bUseRGBATextures;
+
+			// Small chains aren't worth waking up the other threads for.
+			#pragma omp parallel for schedule(dynamic) if (g_ActiveConfig.bOMPDecoder && mips_size >= 64 * 1024)
+			for (int i = 0; i < (int)mips.size(); ++i)
+			{
+				const MipLevel& mip = mips[i];
+				TexDecoder_Decode(mips_data + mip.offset, mip.src, mip.expanded_width, mip.expanded_height, texformat, tlutaddr, tlutfmt, rgba_only);
+			}
+
+			for (; level != texLevels; ++level)
+			{
+				const MipLevel& mip = mips[level - 1];
+				memcpy(temp, mips_data + mip.offset, mip.expanded_width * mip.expanded_height * 4);
 
-				entry->Load(mip_width, mip_height, expanded_mip_width, level);
+				entry->Load(mip.width, mip.height, mip.expanded_width, level);
 
 				if (g_ActiveConfig.bDumpTextures)
 					DumpTexture(entry, level);
@@ -864,7 +963,7 @@ void TextureCache::CopyRenderTargetToTexture(u32 dstAddr, unsigned int dstFormat
 		else if (!(entry->type == TCET_EC_VRAM && entry->virtual_width == scaled_tex_w && entry->virtual_height == scaled_tex_h))
 		{
 			// remove it and recreate it as a render target
-			delete entry;
+			FreeTexture(entry);
 			entry = nullptr;
 		}
 	}
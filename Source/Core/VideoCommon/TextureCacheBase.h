@@ -4,7 +4,7 @@
 
 #pragma once
 
-#include <map>
+#include <unordered_map>
 
 #include "Common/CommonTypes.h"
 #include "Common/Thread.h"
@@ -45,6 +45,12 @@ public:
 		// used to delete textures which haven't been used for TEXTURE_KILL_THRESHOLD frames
 		int frameCount;
 
+		// Identifies the size, level count and format the backend texture was created with,
+		// so that it can be recycled by the texture pool. 0 if it mustn't be pooled.
+		u64 pool_key;
+
+		TCacheEntryBase() : pool_key(0) {}
+
 
 		void SetGeneralParameters(u32 _addr, u32 _size, u32 _format, unsigned int _num_mipmaps)
 		{
@@ -119,9 +125,18 @@ private:
 	static PC_TexFormat LoadCustomTexture(u64 tex_hash, int texformat, unsigned int level, unsigned int& width, unsigned int& height);
 	static void DumpTexture(TCacheEntryBase* entry, unsigned int level);
 
-	typedef std::map<u32, TCacheEntryBase*> TexCache;
+	// Takes a texture out of the pool if one with the given parameters is available, otherwise creates a new one.
+	// Either way, level 0 is loaded from temp.
+	static TCacheEntryBase* AllocateTexture(unsigned int width, unsigned int height,
+		unsigned int expanded_width, unsigned int tex_levels, PC_TexFormat pcfmt);
+	// Returns a texture to the pool, or deletes it if it can't be reused.
+	static void FreeTexture(TCacheEntryBase* entry);
+
+	typedef std::unordered_map<u32, TCacheEntryBase*> TexCache;
+	typedef std::unordered_multimap<u64, TCacheEntryBase*> TexPool;
 
 	static TexCache textures;
+	static TexPool texture_pool;
 
 	// Backup configuration values
 	static struct BackupConfig
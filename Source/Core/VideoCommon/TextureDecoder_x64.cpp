@@ -26,6 +26,23 @@
 #include <tmmintrin.h>
 #endif
 
+// The AVX2 decoders are built with per-function target options, which needs
+// GCC 4.9 or Clang 3.8; MSVC accepts the intrinsics anywhere.
+#if defined(_MSC_VER) && _MSC_VER >= 1800
+#define _M_AVX2_DECODERS 1
+#define AVX2_TARGET
+#elif (defined(__clang__) && (__clang_major__ * 100 + __clang_minor__ >= 308)) || \
+      (!defined(__clang__) && defined(__GNUC__) && (__GNUC__ * 100 + __GNUC_MINOR__ >= 409))
+#define _M_AVX2_DECODERS 1
+#define AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define _M_AVX2_DECODERS 0
+#endif
+
+#if _M_AVX2_DECODERS
+#include <immintrin.h>
+#endif
+
 // This avoids a harmless warning from a system header in Clang;
 // see http://llvm.org/bugs/show_bug.cgi?id=16093
 #if defined(__clang__) && (__clang_major__ * 100 + __clang_minor__ < 304)
@@ -946,6 +963,341 @@ static PC_TexFormat TexDecoder_Decode_real(u8 *dst, const u8 *src, int width, in
 
 
 
+#if _M_AVX2_DECODERS
+// AVX2 versions of the RGBA decoders. They are compiled for AVX2 one function
+// at a time, so that the rest of this file still runs on any x86-64 CPU, and
+// they are only called when cpu_info.bAVX2 is set. Don't add global vector
+// constants here: their initializers would run on every CPU.
+//
+// Each of them decodes one row of blocks, two horizontally adjacent blocks at a
+// time. A trailing odd block is decoded as a pair with itself, and only its
+// half of the result is stored.
+typedef void (*BlockRowDecoderAVX2)(u32* dst, const u8* src, int width, int num_blocks, const u16* tlut, int tlutfmt);
+
+// Expands 16 intensity values to 16 RGBA texels: the first 8 for the left block,
+// the other 8 for the right one.
+static AVX2_TARGET inline void StoreIntensity16_AVX2(u32* dst, __m128i intensity, bool pair)
+{
+	const __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(intensity), intensity, 1);
+	const __m256i mask0 = _mm256_setr_epi8(0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+	                                       4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7);
+	const __m256i mask1 = _mm256_add_epi8(mask0, _mm256_set1_epi8(8));
+	_mm256_storeu_si256((__m256i*)dst, _mm256_shuffle_epi8(v, mask0));
+	if (pair)
+		_mm256_storeu_si256((__m256i*)(dst + 8), _mm256_shuffle_epi8(v, mask1));
+}
+
+// Stores 8 texels, 4 for each block of the pair.
+static AVX2_TARGET inline void Store4x2_AVX2(u32* dst, __m256i texels, bool pair)
+{
+	if (pair)
+		_mm256_storeu_si256((__m256i*)dst, texels);
+	else
+		_mm_storeu_si128((__m128i*)dst, _mm256_castsi256_si128(texels));
+}
+
+// Row iy of a pair of blocks with 4 bytes per row, as [left | right].
+static AVX2_TARGET inline __m128i LoadRows4_AVX2(const u8* block, int iy, bool pair)
+{
+	const __m128i r0 = _mm_cvtsi32_si128(*(const int*)(block + iy * 4));
+	const __m128i r1 = pair ? _mm_cvtsi32_si128(*(const int*)(block + 32 + iy * 4)) : r0;
+	return _mm_unpacklo_epi32(r0, r1);
+}
+
+// Row iy of a pair of blocks with 8 bytes per row, as [left | right].
+static AVX2_TARGET inline __m128i LoadRows8_AVX2(const u8* block, int iy, bool pair)
+{
+	const __m128i r0 = _mm_loadl_epi64((const __m128i*)(block + iy * 8));
+	const __m128i r1 = pair ? _mm_loadl_epi64((const __m128i*)(block + 32 + iy * 8)) : r0;
+	return _mm_unpacklo_epi64(r0, r1);
+}
+
+// Splits 8 bytes into 16 nibbles, high nibble first.
+static AVX2_TARGET inline __m128i ExpandNibbles_AVX2(__m128i bytes)
+{
+	const __m128i mask = _mm_set1_epi8(0x0F);
+	const __m128i hi = _mm_and_si128(_mm_srli_epi16(bytes, 4), mask);
+	const __m128i lo = _mm_and_si128(bytes, mask);
+	return _mm_unpacklo_epi8(hi, lo);
+}
+
+// Big-endian 16-bit values to zero-extended 32-bit ones.
+static AVX2_TARGET inline __m256i LoadBE16_AVX2(__m128i data)
+{
+	const __m128i swap = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+	return _mm256_cvtepu16_epi32(_mm_shuffle_epi8(data, swap));
+}
+
+// Same as decode565RGBA, for 8 values.
+static AVX2_TARGET inline __m256i Decode565_AVX2(__m256i c)
+{
+	const __m256i r5 = _mm256_srli_epi32(c, 11);
+	const __m256i g6 = _mm256_and_si256(_mm256_srli_epi32(c, 5), _mm256_set1_epi32(0x3F));
+	const __m256i b5 = _mm256_and_si256(c, _mm256_set1_epi32(0x1F));
+	const __m256i r = _mm256_or_si256(_mm256_slli_epi32(r5, 3), _mm256_srli_epi32(r5, 2));
+	const __m256i g = _mm256_or_si256(_mm256_slli_epi32(g6, 2), _mm256_srli_epi32(g6, 4));
+	const __m256i b = _mm256_or_si256(_mm256_slli_epi32(b5, 3), _mm256_srli_epi32(b5, 2));
+	return _mm256_or_si256(_mm256_or_si256(r, _mm256_slli_epi32(g, 8)),
+	                       _mm256_or_si256(_mm256_slli_epi32(b, 16), _mm256_set1_epi32(0xFF000000)));
+}
+
+// Same as decode5A3RGBA for 8 values, or decode5A3 if bgra is set.
+static AVX2_TARGET inline __m256i Decode5A3_AVX2(__m256i c, bool bgra)
+{
+	const __m256i mask5 = _mm256_set1_epi32(0x1F);
+	const __m256i mask4 = _mm256_set1_epi32(0x0F);
+
+	// RGB555
+	const __m256i r5 = _mm256_and_si256(_mm256_srli_epi32(c, 10), mask5);
+	const __m256i g5 = _mm256_and_si256(_mm256_srli_epi32(c, 5), mask5);
+	const __m256i b5 = _mm256_and_si256(c, mask5);
+	const __m256i r5x = _mm256_or_si256(_mm256_slli_epi32(r5, 3), _mm256_srli_epi32(r5, 2));
+	const __m256i g5x = _mm256_or_si256(_mm256_slli_epi32(g5, 3), _mm256_srli_epi32(g5, 2));
+	const __m256i b5x = _mm256_or_si256(_mm256_slli_epi32(b5, 3), _mm256_srli_epi32(b5, 2));
+
+	// RGB4A3
+	const __m256i a3 = _mm256_and_si256(_mm256_srli_epi32(c, 12), _mm256_set1_epi32(0x07));
+	const __m256i r4 = _mm256_and_si256(_mm256_srli_epi32(c, 8), mask4);
+	const __m256i g4 = _mm256_and_si256(_mm256_srli_epi32(c, 4), mask4);
+	const __m256i b4 = _mm256_and_si256(c, mask4);
+	const __m256i a3x = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(a3, 5), _mm256_slli_epi32(a3, 2)), _mm256_srli_epi32(a3, 1));
+	const __m256i r4x = _mm256_or_si256(_mm256_slli_epi32(r4, 4), r4);
+	const __m256i g4x = _mm256_or_si256(_mm256_slli_epi32(g4, 4), g4);
+	const __m256i b4x = _mm256_or_si256(_mm256_slli_epi32(b4, 4), b4);
+
+	const __m256i opaque = _mm256_srai_epi32(_mm256_slli_epi32(c, 16), 31);
+	const __m256i r = _mm256_blendv_epi8(r4x, r5x, opaque);
+	const __m256i g = _mm256_blendv_epi8(g4x, g5x, opaque);
+	const __m256i b = _mm256_blendv_epi8(b4x, b5x, opaque);
+	const __m256i a = _mm256_blendv_epi8(a3x, _mm256_set1_epi32(0xFF), opaque);
+
+	const __m256i low = bgra ? b : r;
+	const __m256i high = bgra ? r : b;
+	return _mm256_or_si256(_mm256_or_si256(low, _mm256_slli_epi32(g, 8)),
+	                       _mm256_or_si256(_mm256_slli_epi32(high, 16), _mm256_slli_epi32(a, 24)));
+}
+
+// Looks up 8 palette indices. Matches the decodebytesC*_To_RGBA helpers.
+static AVX2_TARGET inline __m256i LookupTlut_AVX2(const u16* tlut, __m256i indices, int tlutfmt, bool bgra_5a3)
+{
+	// Reads two bytes past the entry; TLUTs are far enough from the end of TMEM.
+	const __m256i raw = _mm256_and_si256(_mm256_i32gather_epi32((const int*)tlut, indices, 2), _mm256_set1_epi32(0xFFFF));
+	if (tlutfmt == 0)
+	{
+		// IA8, stored as A then I
+		const __m256i i = _mm256_srli_epi32(raw, 8);
+		const __m256i a = _mm256_and_si256(raw, _mm256_set1_epi32(0xFF));
+		return _mm256_or_si256(_mm256_or_si256(i, _mm256_slli_epi32(i, 8)),
+		                       _mm256_or_si256(_mm256_slli_epi32(i, 16), _mm256_slli_epi32(a, 24)));
+	}
+
+	const __m256i c = _mm256_or_si256(_mm256_srli_epi32(raw, 8), _mm256_and_si256(_mm256_slli_epi32(raw, 8), _mm256_set1_epi32(0xFF00)));
+	if (tlutfmt == 2)
+		return Decode5A3_AVX2(c, bgra_5a3);
+	return Decode565_AVX2(c);
+}
+
+static AVX2_TARGET void DecodeI4Row_AVX2(u32* dst, const u8* src, int width, int num_blocks, const u16* tlut, int tlutfmt)
+{
+	for (int bx = 0; bx < num_blocks; bx += 2)
+	{
+		const bool pair = bx + 1 < num_blocks;
+		const u8* block = src + bx * 32;
+		for (int iy = 0; iy < 8; iy++)
+		{
+			const __m128i i4 = ExpandNibbles_AVX2(LoadRows4_AVX2(block, iy, pair));
+			const __m128i i8 = _mm_or_si128(_mm_slli_epi16(i4, 4), i4);
+			StoreIntensity16_AVX2(dst + iy * width + bx * 8, i8, pair);
+		}
+	}
+}
+
+static AVX2_TARGET void DecodeI8Row_AVX2(u32* dst, const u8* src, int width, int num_blocks, const u16* tlut, int tlutfmt)
+{
+	for (int bx = 0; bx < num_blocks; bx += 2)
+	{
+		const bool pair = bx + 1 < num_blocks;
+		const u8* block = src + bx * 32;
+		for (int iy = 0; iy < 4; iy++)
+			StoreIntensity16_AVX2(dst + iy * width + bx * 8, LoadRows8_AVX2(block, iy, pair), pair);
+	}
+}
+
+static AVX2_TARGET void DecodeIA8Row_AVX2(u32* dst, const u8* src, int width, int num_blocks, const u16* tlut, int tlutfmt)
+{
+	const __m256i mask = _mm256_setr_epi8(1, 1, 1, 0, 3, 3, 3, 2, 5, 5, 5, 4, 7, 7, 7, 6,
+	                                      9, 9, 9, 8, 11, 11, 11, 10, 13, 13, 13, 12, 15, 15, 15, 14);
+	for (int bx = 0; bx < num_blocks; bx += 2)
+	{
+		const bool pair = bx + 1 < num_blocks;
+		const u8* block = src + bx * 32;
+		for (int iy = 0; iy < 4; iy++)
+		{
+			const __m128i rows = LoadRows8_AVX2(block, iy, pair);
+			const __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(rows), rows, 1);
+			Store4x2_AVX2(dst + iy * width + bx * 4, _mm256_shuffle_epi8(v, mask), pair);
+		}
+	}
+}
+
+static AVX2_TARGET void DecodeRGB565Row_AVX2(u32* dst, const u8* src, int width, int num_blocks, const u16* tlut, int tlutfmt)
+{
+	for (int bx = 0; bx < num_blocks; bx += 2)
+	{
+		const bool pair = bx + 1 < num_blocks;
+		const u8* block = src + bx * 32;
+		for (int iy = 0; iy < 4; iy++)
+			Store4x2_AVX2(dst + iy * width + bx * 4, Decode565_AVX2(LoadBE16_AVX2(LoadRows8_AVX2(block, iy, pair))), pair);
+	}
+}
+
+static AVX2_TARGET void DecodeRGB5A3Row_AVX2(u32* dst, const u8* src, int width, int num_blocks, const u16* tlut, int tlutfmt)
+{
+	for (int bx = 0; bx < num_blocks; bx += 2)
+	{
+		const bool pair = bx + 1 < num_blocks;
+		const u8* block = src + bx * 32;
+		for (int iy = 0; iy < 4; iy++)
+			Store4x2_AVX2(dst + iy * width + bx * 4, Decode5A3_AVX2(LoadBE16_AVX2(LoadRows8_AVX2(block, iy, pair)), false), pair);
+	}
+}
+
+// 16 palette indices, the first 8 for the left block.
+static AVX2_TARGET inline void StoreIndices16_AVX2(u32* dst, __m128i indices, bool pair, const u16* tlut, int tlutfmt)
+{
+	_mm256_storeu_si256((__m256i*)dst, LookupTlut_AVX2(tlut, _mm256_cvtepu8_epi32(indices), tlutfmt, false));
+	if (pair)
+		_mm256_storeu_si256((__m256i*)(dst + 8), LookupTlut_AVX2(tlut, _mm256_cvtepu8_epi32(_mm_srli_si128(indices, 8)), tlutfmt, false));
+}
+
+static AVX2_TARGET void DecodeC4Row_AVX2(u32* dst, const u8* src, int width, int num_blocks, const u16* tlut, int tlutfmt)
+{
+	for (int bx = 0; bx < num_blocks; bx += 2)
+	{
+		const bool pair = bx + 1 < num_blocks;
+		const u8* block = src + bx * 32;
+		for (int iy = 0; iy < 8; iy++)
+			StoreIndices16_AVX2(dst + iy * width + bx * 8, ExpandNibbles_AVX2(LoadRows4_AVX2(block, iy, pair)), pair, tlut, tlutfmt);
+	}
+}
+
+static AVX2_TARGET void DecodeC8Row_AVX2(u32* dst, const u8* src, int width, int num_blocks, const u16* tlut, int tlutfmt)
+{
+	for (int bx = 0; bx < num_blocks; bx += 2)
+	{
+		const bool pair = bx + 1 < num_blocks;
+		const u8* block = src + bx * 32;
+		for (int iy = 0; iy < 4; iy++)
+			StoreIndices16_AVX2(dst + iy * width + bx * 8, LoadRows8_AVX2(block, iy, pair), pair, tlut, tlutfmt);
+	}
+}
+
+static AVX2_TARGET void DecodeC14X2Row_AVX2(u32* dst, const u8* src, int width, int num_blocks, const u16* tlut, int tlutfmt)
+{
+	const __m256i index_mask = _mm256_set1_epi32(0x3FFF);
+	for (int bx = 0; bx < num_blocks; bx += 2)
+	{
+		const bool pair = bx + 1 < num_blocks;
+		const u8* block = src + bx * 32;
+		for (int iy = 0; iy < 4; iy++)
+		{
+			const __m256i indices = _mm256_and_si256(LoadBE16_AVX2(LoadRows8_AVX2(block, iy, pair)), index_mask);
+			// The non-AVX2 path decodes 5A3 palettes of this format to BGRA.
+			Store4x2_AVX2(dst + iy * width + bx * 4, LookupTlut_AVX2(tlut, indices, tlutfmt, true), pair);
+		}
+	}
+}
+
+// Same colors as decodeDXTBlockRGBA.
+static void GetDXTPaletteRGBA(u32* colors, const DXTBlock* src)
+{
+	u16 c1 = Common::swap16(src->color1);
+	u16 c2 = Common::swap16(src->color2);
+	int blue1 = Convert5To8(c1 & 0x1F);
+	int blue2 = Convert5To8(c2 & 0x1F);
+	int green1 = Convert6To8((c1 >> 5) & 0x3F);
+	int green2 = Convert6To8((c2 >> 5) & 0x3F);
+	int red1 = Convert5To8((c1 >> 11) & 0x1F);
+	int red2 = Convert5To8((c2 >> 11) & 0x1F);
+	colors[0] = makeRGBA(red1, green1, blue1, 255);
+	colors[1] = makeRGBA(red2, green2, blue2, 255);
+	if (c1 > c2)
+	{
+		int blue3 = ((blue2 - blue1) >> 1) - ((blue2 - blue1) >> 3);
+		int green3 = ((green2 - green1) >> 1) - ((green2 - green1) >> 3);
+		int red3 = ((red2 - red1) >> 1) - ((red2 - red1) >> 3);
+		colors[2] = makeRGBA(red1 + red3, green1 + green3, blue1 + blue3, 255);
+		colors[3] = makeRGBA(red2 - red3, green2 - green3, blue2 - blue3, 255);
+	}
+	else
+	{
+		colors[2] = makeRGBA((red1 + red2 + 1) / 2, // Average
+		                     (green1 + green2 + 1) / 2,
+		                     (blue1 + blue2 + 1) / 2, 255);
+		colors[3] = makeRGBA(red2, green2, blue2, 0);  // Color2 but transparent
+	}
+}
+
+// A CMPR block is 2x2 DXT blocks; each row of it is decoded as a pair.
+static AVX2_TARGET void DecodeCMPRRow_AVX2(u32* dst, const u8* src, int width, int num_blocks, const u16* tlut, int tlutfmt)
+{
+	const __m256i shifts = _mm256_setr_epi32(6, 4, 2, 0, 6, 4, 2, 0);
+	const __m256i lane_offset = _mm256_setr_epi32(0, 0, 0, 0, 4, 4, 4, 4);
+	const __m256i mask = _mm256_set1_epi32(3);
+	for (int bx = 0; bx < num_blocks; bx++)
+	{
+		for (int z = 0; z < 2; z++)
+		{
+			const DXTBlock* dxt = (const DXTBlock*)(src + bx * 32 + z * 16);
+			GC_ALIGNED32(u32 colors[8]);
+			GetDXTPaletteRGBA(colors, dxt);
+			GetDXTPaletteRGBA(colors + 4, dxt + 1);
+			const __m256i palette = _mm256_load_si256((const __m256i*)colors);
+
+			for (int iy = 0; iy < 4; iy++)
+			{
+				const int l0 = dxt[0].lines[iy];
+				const int l1 = dxt[1].lines[iy];
+				const __m256i lines = _mm256_setr_epi32(l0, l0, l0, l0, l1, l1, l1, l1);
+				const __m256i indices = _mm256_add_epi32(_mm256_and_si256(_mm256_srlv_epi32(lines, shifts), mask), lane_offset);
+				_mm256_storeu_si256((__m256i*)(dst + (z * 4 + iy) * width + bx * 8), _mm256_permutevar8x32_epi32(palette, indices));
+			}
+		}
+	}
+}
+
+// Returns PC_TEX_FMT_NONE for the formats without an AVX2 decoder.
+static PC_TexFormat TexDecoder_Decode_RGBA_AVX2(u32 * dst, const u8 * src, int width, int height, int texformat, int tlutaddr, int tlutfmt)
+{
+	BlockRowDecoderAVX2 decode_row;
+	int block_width, block_height;
+	switch (texformat)
+	{
+	case GX_TF_I4:     decode_row = DecodeI4Row_AVX2;     block_width = 8; block_height = 8; break;
+	case GX_TF_I8:     decode_row = DecodeI8Row_AVX2;     block_width = 8; block_height = 4; break;
+	case GX_TF_IA8:    decode_row = DecodeIA8Row_AVX2;    block_width = 4; block_height = 4; break;
+	case GX_TF_RGB565: decode_row = DecodeRGB565Row_AVX2; block_width = 4; block_height = 4; break;
+	case GX_TF_RGB5A3: decode_row = DecodeRGB5A3Row_AVX2; block_width = 4; block_height = 4; break;
+	case GX_TF_C4:     decode_row = DecodeC4Row_AVX2;     block_width = 8; block_height = 8; break;
+	case GX_TF_C8:     decode_row = DecodeC8Row_AVX2;     block_width = 8; block_height = 4; break;
+	case GX_TF_C14X2:  decode_row = DecodeC14X2Row_AVX2;  block_width = 4; block_height = 4; break;
+	case GX_TF_CMPR:   decode_row = DecodeCMPRRow_AVX2;   block_width = 8; block_height = 8; break;
+	default:
+		return PC_TEX_FMT_NONE;
+	}
+
+	SetOpenMPThreadCount(width, height);
+
+	const int num_blocks = (width + block_width - 1) / block_width;
+	const u16* tlut = (const u16*)(texMem + tlutaddr);
+	#pragma omp parallel for
+	for (int y = 0; y < height; y += block_height)
+		decode_row(dst + y * width, src + (y / block_height) * num_blocks * 32, width, num_blocks, tlut, tlutfmt);
+
+	return PC_TEX_FMT_RGBA32;
+}
+#endif
+
 // JSD 01/06/11:
 // TODO: we really should ensure BOTH the source and destination addresses are aligned to 16-byte boundaries to
 // squeeze out a little more performance. _mm_loadu_si128/_mm_storeu_si128 is slower than _mm_load_si128/_mm_store_si128
@@ -956,6 +1308,15 @@ static PC_TexFormat TexDecoder_Decode_real(u8 *dst, const u8 *src, int width, in
 
 static PC_TexFormat TexDecoder_Decode_RGBA(u32 * dst, const u8 * src, int width, int height, int texformat, int tlutaddr, int tlutfmt)
 {
+#if _M_AVX2_DECODERS
+	if (cpu_info.bAVX2)
+	{
+		PC_TexFormat pcfmt = TexDecoder_Decode_RGBA_AVX2(dst, src, width, height, texformat, tlutaddr, tlutfmt);
+		if (pcfmt != PC_TEX_FMT_NONE)
+			return pcfmt;
+	}
+#endif
+
 	SetOpenMPThreadCount(width, height);
 
 	const int Wsteps4 = (width + 3) / 4;
@@ -76,6 +76,19 @@ static const float fractionTable[32] = {
 
 using namespace Gen;
 
+#ifdef USE_VERTEX_LOADER_JIT
+// Registers of the compiled loaders. They are callee saved so that the calls
+// to pipeline functions don't clobber them. RAX, RCX, RDX, XMM0 and XMM1 are
+// used as temporaries.
+static const X64Reg src_reg = R12;
+static const X64Reg dst_reg = R13;
+static const X64Reg count_reg = R14;
+static const X64Reg vertex_reg = RBX;  // start of the current source vertex, for the matrix indices
+
+// Same as FracAdjust in VertexLoader_Normal.cpp.
+static const float s_normal_scale[] = { 1.0f / (1U << 7), 1.0f / (1U << 6), 1.0f / (1U << 15), 1.0f / (1U << 14) };
+#endif
+
 static void LOADERDECL PosMtx_ReadDirect_UByte()
 {
 	s_curposmtx = DataReadU8() & 0x3f;
@@ -492,26 +505,15 @@ void VertexLoader::CompileVertexTranslator()
 
 	m_compiledCode = GetCodePtr();
 	ABI_PushAllCalleeSavedRegsAndAdjustStack();
+	WriteGetVariable(64, R(src_reg), &g_pVideoData);
+	WriteGetVariable(64, R(dst_reg), &VertexManager::s_pCurBufferPointer);
+	WriteGetVariable(32, R(count_reg), &loop_counter);
 
 	// Start loop here
 	const u8 *loop_start = GetCodePtr();
-
-	// Reset component counters if present in vertex format only.
-	if (m_VtxDesc.Tex0Coord || m_VtxDesc.Tex1Coord || m_VtxDesc.Tex2Coord || m_VtxDesc.Tex3Coord ||
-		m_VtxDesc.Tex4Coord || m_VtxDesc.Tex5Coord || m_VtxDesc.Tex6Coord || m_VtxDesc.Tex7Coord)
-	{
-		WriteSetVariable(32, &tcIndex, Imm32(0));
-	}
-	if (m_VtxDesc.Color0 || m_VtxDesc.Color1)
-	{
-		WriteSetVariable(32, &colIndex, Imm32(0));
-	}
-	if (m_VtxDesc.Tex0MatIdx || m_VtxDesc.Tex1MatIdx || m_VtxDesc.Tex2MatIdx || m_VtxDesc.Tex3MatIdx ||
-		m_VtxDesc.Tex4MatIdx || m_VtxDesc.Tex5MatIdx || m_VtxDesc.Tex6MatIdx || m_VtxDesc.Tex7MatIdx)
-	{
-		WriteSetVariable(32, &s_texmtxwrite, Imm32(0));
-		WriteSetVariable(32, &s_texmtxread, Imm32(0));
-	}
+	m_src_ofs = m_dst_ofs = 0;
+	if (m_VtxDesc.Hex & 0x1FF)
+		MOV(64, R(vertex_reg), R(src_reg));
 #else
 	// Reset pipeline
 	m_numPipelineStages = 0;
@@ -537,30 +539,30 @@ void VertexLoader::CompileVertexTranslator()
 	// Position Matrix Index
 	if (m_VtxDesc.PosMatIdx)
 	{
-		WriteCall(PosMtx_ReadDirect_UByte);
+		WriteMtxIdxRead(PosMtx_ReadDirect_UByte);
 		components |= VB_HAS_POSMTXIDX;
 		m_VertexSize += 1;
 	}
 
-	if (m_VtxDesc.Tex0MatIdx) {m_VertexSize += 1; components |= VB_HAS_TEXMTXIDX0; WriteCall(TexMtx_ReadDirect_UByte); }
-	if (m_VtxDesc.Tex1MatIdx) {m_VertexSize += 1; components |= VB_HAS_TEXMTXIDX1; WriteCall(TexMtx_ReadDirect_UByte); }
-	if (m_VtxDesc.Tex2MatIdx) {m_VertexSize += 1; components |= VB_HAS_TEXMTXIDX2; WriteCall(TexMtx_ReadDirect_UByte); }
-	if (m_VtxDesc.Tex3MatIdx) {m_VertexSize += 1; components |= VB_HAS_TEXMTXIDX3; WriteCall(TexMtx_ReadDirect_UByte); }
-	if (m_VtxDesc.Tex4MatIdx) {m_VertexSize += 1; components |= VB_HAS_TEXMTXIDX4; WriteCall(TexMtx_ReadDirect_UByte); }
-	if (m_VtxDesc.Tex5MatIdx) {m_VertexSize += 1; components |= VB_HAS_TEXMTXIDX5; WriteCall(TexMtx_ReadDirect_UByte); }
-	if (m_VtxDesc.Tex6MatIdx) {m_VertexSize += 1; components |= VB_HAS_TEXMTXIDX6; WriteCall(TexMtx_ReadDirect_UByte); }
-	if (m_VtxDesc.Tex7MatIdx) {m_VertexSize += 1; components |= VB_HAS_TEXMTXIDX7; WriteCall(TexMtx_ReadDirect_UByte); }
+	if (m_VtxDesc.Tex0MatIdx) {m_VertexSize += 1; components |= VB_HAS_TEXMTXIDX0; WriteMtxIdxRead(TexMtx_ReadDirect_UByte); }
+	if (m_VtxDesc.Tex1MatIdx) {m_VertexSize += 1; components |= VB_HAS_TEXMTXIDX1; WriteMtxIdxRead(TexMtx_ReadDirect_UByte); }
+	if (m_VtxDesc.Tex2MatIdx) {m_VertexSize += 1; components |= VB_HAS_TEXMTXIDX2; WriteMtxIdxRead(TexMtx_ReadDirect_UByte); }
+	if (m_VtxDesc.Tex3MatIdx) {m_VertexSize += 1; components |= VB_HAS_TEXMTXIDX3; WriteMtxIdxRead(TexMtx_ReadDirect_UByte); }
+	if (m_VtxDesc.Tex4MatIdx) {m_VertexSize += 1; components |= VB_HAS_TEXMTXIDX4; WriteMtxIdxRead(TexMtx_ReadDirect_UByte); }
+	if (m_VtxDesc.Tex5MatIdx) {m_VertexSize += 1; components |= VB_HAS_TEXMTXIDX5; WriteMtxIdxRead(TexMtx_ReadDirect_UByte); }
+	if (m_VtxDesc.Tex6MatIdx) {m_VertexSize += 1; components |= VB_HAS_TEXMTXIDX6; WriteMtxIdxRead(TexMtx_ReadDirect_UByte); }
+	if (m_VtxDesc.Tex7MatIdx) {m_VertexSize += 1; components |= VB_HAS_TEXMTXIDX7; WriteMtxIdxRead(TexMtx_ReadDirect_UByte); }
 
 	// Write vertex position loader
 	if (g_ActiveConfig.bUseBBox)
 	{
 		WriteCall(UpdateBoundingBoxPrepare);
-		WriteCall(VertexLoader_Position::GetFunction(m_VtxDesc.Position, m_VtxAttr.PosFormat, m_VtxAttr.PosElements));
+		WritePosition(VertexLoader_Position::GetFunction(m_VtxDesc.Position, m_VtxAttr.PosFormat, m_VtxAttr.PosElements));
 		WriteCall(UpdateBoundingBox);
 	}
 	else
 	{
-		WriteCall(VertexLoader_Position::GetFunction(m_VtxDesc.Position, m_VtxAttr.PosFormat, m_VtxAttr.PosElements));
+		WritePosition(VertexLoader_Position::GetFunction(m_VtxDesc.Position, m_VtxAttr.PosFormat, m_VtxAttr.PosElements));
 	}
 	m_VertexSize += VertexLoader_Position::GetSize(m_VtxDesc.Position, m_VtxAttr.PosFormat, m_VtxAttr.PosElements);
 	nat_offset += 12;
@@ -586,7 +588,7 @@ void VertexLoader::CompileVertexTranslator()
 				m_VtxDesc.Normal, m_VtxAttr.NormalFormat,
 				m_VtxAttr.NormalElements, m_VtxAttr.NormalIndex3).c_str());
 		}
-		WriteCall(pFunc);
+		WriteNormals(pFunc);
 
 		for (int i = 0; i < (vtx_attr.NormalElements ? 3 : 1); i++)
 		{
@@ -615,12 +617,12 @@ void VertexLoader::CompileVertexTranslator()
 		case DIRECT:
 			switch (m_VtxAttr.color[i].Comp)
 			{
-			case FORMAT_16B_565:  m_VertexSize += 2; WriteCall(Color_ReadDirect_16b_565); break;
-			case FORMAT_24B_888:  m_VertexSize += 3; WriteCall(Color_ReadDirect_24b_888); break;
-			case FORMAT_32B_888x: m_VertexSize += 4; WriteCall(Color_ReadDirect_32b_888x); break;
-			case FORMAT_16B_4444: m_VertexSize += 2; WriteCall(Color_ReadDirect_16b_4444); break;
-			case FORMAT_24B_6666: m_VertexSize += 3; WriteCall(Color_ReadDirect_24b_6666); break;
-			case FORMAT_32B_8888: m_VertexSize += 4; WriteCall(Color_ReadDirect_32b_8888); break;
+			case FORMAT_16B_565:  m_VertexSize += 2; WriteColor(i, col[i], Color_ReadDirect_16b_565); break;
+			case FORMAT_24B_888:  m_VertexSize += 3; WriteColor(i, col[i], Color_ReadDirect_24b_888); break;
+			case FORMAT_32B_888x: m_VertexSize += 4; WriteColor(i, col[i], Color_ReadDirect_32b_888x); break;
+			case FORMAT_16B_4444: m_VertexSize += 2; WriteColor(i, col[i], Color_ReadDirect_16b_4444); break;
+			case FORMAT_24B_6666: m_VertexSize += 3; WriteColor(i, col[i], Color_ReadDirect_24b_6666); break;
+			case FORMAT_32B_8888: m_VertexSize += 4; WriteColor(i, col[i], Color_ReadDirect_32b_8888); break;
 			default: _assert_(0); break;
 			}
 			break;
@@ -628,12 +630,12 @@ void VertexLoader::CompileVertexTranslator()
 			m_VertexSize += 1;
 			switch (m_VtxAttr.color[i].Comp)
 			{
-			case FORMAT_16B_565:  WriteCall(Color_ReadIndex8_16b_565); break;
-			case FORMAT_24B_888:  WriteCall(Color_ReadIndex8_24b_888); break;
-			case FORMAT_32B_888x: WriteCall(Color_ReadIndex8_32b_888x); break;
-			case FORMAT_16B_4444: WriteCall(Color_ReadIndex8_16b_4444); break;
-			case FORMAT_24B_6666: WriteCall(Color_ReadIndex8_24b_6666); break;
-			case FORMAT_32B_8888: WriteCall(Color_ReadIndex8_32b_8888); break;
+			case FORMAT_16B_565:  WriteColor(i, col[i], Color_ReadIndex8_16b_565); break;
+			case FORMAT_24B_888:  WriteColor(i, col[i], Color_ReadIndex8_24b_888); break;
+			case FORMAT_32B_888x: WriteColor(i, col[i], Color_ReadIndex8_32b_888x); break;
+			case FORMAT_16B_4444: WriteColor(i, col[i], Color_ReadIndex8_16b_4444); break;
+			case FORMAT_24B_6666: WriteColor(i, col[i], Color_ReadIndex8_24b_6666); break;
+			case FORMAT_32B_8888: WriteColor(i, col[i], Color_ReadIndex8_32b_8888); break;
 			default: _assert_(0); break;
 			}
 			break;
@@ -641,12 +643,12 @@ void VertexLoader::CompileVertexTranslator()
 			m_VertexSize += 2;
 			switch (m_VtxAttr.color[i].Comp)
 			{
-			case FORMAT_16B_565:  WriteCall(Color_ReadIndex16_16b_565); break;
-			case FORMAT_24B_888:  WriteCall(Color_ReadIndex16_24b_888); break;
-			case FORMAT_32B_888x: WriteCall(Color_ReadIndex16_32b_888x); break;
-			case FORMAT_16B_4444: WriteCall(Color_ReadIndex16_16b_4444); break;
-			case FORMAT_24B_6666: WriteCall(Color_ReadIndex16_24b_6666); break;
-			case FORMAT_32B_8888: WriteCall(Color_ReadIndex16_32b_8888); break;
+			case FORMAT_16B_565:  WriteColor(i, col[i], Color_ReadIndex16_16b_565); break;
+			case FORMAT_24B_888:  WriteColor(i, col[i], Color_ReadIndex16_24b_888); break;
+			case FORMAT_32B_888x: WriteColor(i, col[i], Color_ReadIndex16_32b_888x); break;
+			case FORMAT_16B_4444: WriteColor(i, col[i], Color_ReadIndex16_16b_4444); break;
+			case FORMAT_24B_6666: WriteColor(i, col[i], Color_ReadIndex16_24b_6666); break;
+			case FORMAT_32B_8888: WriteColor(i, col[i], Color_ReadIndex16_32b_8888); break;
 			default: _assert_(0); break;
 			}
 			break;
@@ -682,7 +684,7 @@ void VertexLoader::CompileVertexTranslator()
 			_assert_msg_(VIDEO, 0 <= elements && elements <= 1, "Invalid number of texture coordinates elements!\n(elements = %d)", elements);
 
 			components |= VB_HAS_UV0 << i;
-			WriteCall(VertexLoader_TextCoord::GetFunction(tc[i], format, elements));
+			WriteTexCoord(i, tc[i], VertexLoader_TextCoord::GetFunction(tc[i], format, elements));
 			m_VertexSize += VertexLoader_TextCoord::GetSize(tc[i], format, elements);
 		}
 
@@ -694,14 +696,14 @@ void VertexLoader::CompileVertexTranslator()
 				// if texmtx is included, texcoord will always be 3 floats, z will be the texmtx index
 				m_native_vtx_decl.texcoords[i].components = 3;
 				nat_offset += 12;
-				WriteCall(m_VtxAttr.texCoord[i].Elements ? TexMtx_Write_Float : TexMtx_Write_Float2);
+				WriteMtxIdxWrite(i, m_VtxAttr.texCoord[i].Elements ? TexMtx_Write_Float : TexMtx_Write_Float2);
 			}
 			else
 			{
 				components |= VB_HAS_UV0 << i; // have to include since using now
 				m_native_vtx_decl.texcoords[i].components = 4;
 				nat_offset += 16; // still include the texture coordinate, but this time as 6 + 2 bytes
-				WriteCall(TexMtx_Write_Float4);
+				WriteMtxIdxWrite(i, TexMtx_Write_Float4);
 			}
 		}
 		else
@@ -722,7 +724,9 @@ void VertexLoader::CompileVertexTranslator()
 			{
 				if (tc[j] != NOT_PRESENT)
 				{
+#ifndef USE_VERTEX_LOADER_JIT
 					WriteCall(VertexLoader_TextCoord::GetDummyFunction()); // important to get indices right!
+#endif
 					break;
 				}
 			}
@@ -737,7 +741,7 @@ void VertexLoader::CompileVertexTranslator()
 
 	if (m_VtxDesc.PosMatIdx)
 	{
-		WriteCall(PosMtx_Write);
+		WriteMtxIdxWrite(-1, PosMtx_Write);
 		m_native_vtx_decl.posmtx.components = 4;
 		m_native_vtx_decl.posmtx.enable = true;
 		m_native_vtx_decl.posmtx.offset = nat_offset;
@@ -751,10 +755,12 @@ void VertexLoader::CompileVertexTranslator()
 
 #ifdef USE_VERTEX_LOADER_JIT
 	// End loop here
-	MOV(64, R(RAX), Imm64((u64)&loop_counter));
-	SUB(32, MatR(RAX), Imm8(1));
-
+	AdvancePointers();
+	SUB(32, R(count_reg), Imm8(1));
 	J_CC(CC_NZ, loop_start);
+
+	WriteSetVariable(64, &g_pVideoData, R(src_reg));
+	WriteSetVariable(64, &VertexManager::s_pCurBufferPointer, R(dst_reg));
 	ABI_PopAllCalleeSavedRegsAndAdjustStack();
 	RET();
 #endif
@@ -763,12 +769,331 @@ void VertexLoader::CompileVertexTranslator()
 void VertexLoader::WriteCall(TPipelineFunction func)
 {
 #ifdef USE_VERTEX_LOADER_JIT
+	// The pipeline functions work on the global pointers.
+	AdvancePointers();
+	WriteSetVariable(64, &g_pVideoData, R(src_reg));
+	WriteSetVariable(64, &VertexManager::s_pCurBufferPointer, R(dst_reg));
 	MOV(64, R(RAX), Imm64((u64)func));
 	CALLptr(R(RAX));
+	WriteGetVariable(64, R(src_reg), &g_pVideoData);
+	WriteGetVariable(64, R(dst_reg), &VertexManager::s_pCurBufferPointer);
 #else
 	m_PipelineStages[m_numPipelineStages++] = func;
 #endif
 }
+#ifdef USE_VERTEX_LOADER_JIT
+static int GetComponentSize(int format)
+{
+	return format == FORMAT_FLOAT ? 4 : format >= FORMAT_USHORT ? 2 : 1;
+}
+
+void VertexLoader::AdvancePointers()
+{
+	if (m_src_ofs)
+		ADD(64, R(src_reg), Imm32(m_src_ofs));
+	if (m_dst_ofs)
+		ADD(64, R(dst_reg), Imm32(m_dst_ofs));
+	m_src_ofs = m_dst_ofs = 0;
+}
+
+// Returns the register to read the attribute from, at *offset. Indexed
+// attributes are looked up in their array, direct ones take direct_size bytes
+// of the vertex.
+X64Reg VertexLoader::GetVertexAddr(int array, u32 attribute, int direct_size, int* offset)
+{
+	if (attribute == DIRECT)
+	{
+		*offset = m_src_ofs;
+		m_src_ofs += direct_size;
+		return src_reg;
+	}
+
+	if (attribute == INDEX8)
+	{
+		MOVZX(32, 8, EAX, MDisp(src_reg, m_src_ofs));
+		m_src_ofs += 1;
+	}
+	else
+	{
+		MOVZX(32, 16, EAX, MDisp(src_reg, m_src_ofs));
+		ROL(16, R(EAX), Imm8(8));
+		m_src_ofs += 2;
+	}
+	MOV(64, R(RCX), Imm64((u64)&arraystrides[array]));
+	IMUL(32, EAX, MatR(RCX));
+	MOV(64, R(RCX), Imm64((u64)&cached_arraybases[array]));
+	MOV(64, R(RCX), MatR(RCX));
+	ADD(64, R(RCX), R(RAX));
+	*offset = 0;
+	return RCX;
+}
+
+void VertexLoader::LoadScale(const float* scale)
+{
+	MOV(64, R(RAX), Imm64((u64)scale));
+	MOVSS(XMM1, MatR(RAX));
+}
+
+// Writes count components read from base + offset as floats. Integer ones are
+// scaled by XMM1.
+void VertexLoader::ConvertComponents(int format, X64Reg base, int offset, int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		const OpArg src = MDisp(base, offset + i * GetComponentSize(format));
+		switch (format)
+		{
+		case FORMAT_UBYTE:
+			MOVZX(32, 8, EAX, src);
+			break;
+		case FORMAT_BYTE:
+			MOVSX(32, 8, EAX, src);
+			break;
+		case FORMAT_USHORT:
+			MOVZX(32, 16, EAX, src);
+			ROL(16, R(EAX), Imm8(8));
+			break;
+		case FORMAT_SHORT:
+			MOVZX(32, 16, EAX, src);
+			BSWAP(32, EAX);
+			SAR(32, R(EAX), Imm8(16));
+			break;
+		case FORMAT_FLOAT:
+			MOV(32, R(EAX), src);
+			BSWAP(32, EAX);
+			break;
+		}
+
+		if (format == FORMAT_FLOAT)
+		{
+			MOV(32, MDisp(dst_reg, m_dst_ofs), R(EAX));
+		}
+		else
+		{
+			MOVD_xmm(XMM0, R(EAX));
+			CVTDQ2PS(XMM0, R(XMM0));
+			MULSS(XMM0, R(XMM1));
+			MOVSS(MDisp(dst_reg, m_dst_ofs), XMM0);
+		}
+		m_dst_ofs += 4;
+	}
+}
+
+// dest |= (src << shift) & mask, a negative shift being a right shift.
+void VertexLoader::OrShiftedMask(X64Reg dest, X64Reg src, int shift, u32 mask)
+{
+	MOV(32, R(ECX), R(src));
+	if (shift > 0)
+		SHL(32, R(ECX), Imm8(shift));
+	else if (shift < 0)
+		SHR(32, R(ECX), Imm8(-shift));
+	if (mask != 0xFFFFFFFF)
+		AND(32, R(ECX), Imm32(mask));
+	OR(32, R(dest), R(ECX));
+}
+#endif
+
+void VertexLoader::WriteMtxIdxRead(TPipelineFunction func)
+{
+#ifdef USE_VERTEX_LOADER_JIT
+	// The indices are read through vertex_reg when they are written, but the
+	// bounding box needs s_curposmtx before the position.
+	if (func == PosMtx_ReadDirect_UByte && g_ActiveConfig.bUseBBox)
+		WriteCall(func);
+	else
+		m_src_ofs += 1;
+#else
+	WriteCall(func);
+#endif
+}
+
+// i is the texture coordinate, or -1 for the position matrix index.
+void VertexLoader::WriteMtxIdxWrite(int i, TPipelineFunction func)
+{
+#ifdef USE_VERTEX_LOADER_JIT
+	if (i < 0 && g_ActiveConfig.bUseBBox)
+	{
+		// Resets s_curposmtx
+		WriteCall(func);
+		return;
+	}
+
+	// The position matrix index comes first, then the texture ones in order.
+	int offset = 0;
+	for (int j = 0; j <= i; j++)
+		offset += (m_VtxDesc.Hex >> j) & 1;
+
+	MOVZX(32, 8, EAX, MDisp(vertex_reg, offset));
+	AND(32, R(EAX), Imm8(0x3f));
+	if (i < 0)
+	{
+		MOV(32, MDisp(dst_reg, m_dst_ofs), R(EAX));
+		m_dst_ofs += 4;
+		return;
+	}
+
+	MOVD_xmm(XMM0, R(EAX));
+	CVTDQ2PS(XMM0, R(XMM0));
+	const int padding = func == TexMtx_Write_Float ? 0 : func == TexMtx_Write_Float2 ? 1 : 2;
+	for (int j = 0; j < padding; j++)
+	{
+		MOV(32, MDisp(dst_reg, m_dst_ofs), Imm32(0));
+		m_dst_ofs += 4;
+	}
+	MOVSS(MDisp(dst_reg, m_dst_ofs), XMM0);
+	m_dst_ofs += 4;
+	if (func == TexMtx_Write_Float4)
+	{
+		MOV(32, MDisp(dst_reg, m_dst_ofs), Imm32(0));
+		m_dst_ofs += 4;
+	}
+#else
+	WriteCall(func);
+#endif
+}
+
+void VertexLoader::WritePosition(TPipelineFunction func)
+{
+#ifdef USE_VERTEX_LOADER_JIT
+	const int format = m_VtxAttr.PosFormat;
+	if (m_VtxDesc.Position == NOT_PRESENT || format > FORMAT_FLOAT)
+	{
+		WriteCall(func);
+		return;
+	}
+
+	const int elements = m_VtxAttr.PosElements ? 3 : 2;
+	int offset;
+	X64Reg base = GetVertexAddr(ARRAY_POSITION, m_VtxDesc.Position, elements * GetComponentSize(format), &offset);
+	if (format != FORMAT_FLOAT)
+		LoadScale(&posScale);
+	ConvertComponents(format, base, offset, elements);
+	if (elements == 2)
+	{
+		MOV(32, MDisp(dst_reg, m_dst_ofs), Imm32(0));
+		m_dst_ofs += 4;
+	}
+#else
+	WriteCall(func);
+#endif
+}
+
+void VertexLoader::WriteNormals(TPipelineFunction func)
+{
+#ifdef USE_VERTEX_LOADER_JIT
+	const int format = m_VtxAttr.NormalFormat;
+	if (format > FORMAT_FLOAT)
+	{
+		WriteCall(func);
+		return;
+	}
+
+	const u32 attribute = m_VtxDesc.Normal;
+	const int count = m_VtxAttr.NormalElements ? 3 : 1;
+	const int size = 3 * GetComponentSize(format);
+	int offset;
+	if (format != FORMAT_FLOAT)
+		LoadScale(&s_normal_scale[format]);
+	if (m_VtxAttr.NormalIndex3 && count == 3 && attribute != DIRECT)
+	{
+		// The normal, binormal and tangent have an index each.
+		for (int i = 0; i < 3; i++)
+		{
+			X64Reg base = GetVertexAddr(ARRAY_NORMAL, attribute, 0, &offset);
+			ConvertComponents(format, base, offset + i * size, 3);
+		}
+	}
+	else
+	{
+		X64Reg base = GetVertexAddr(ARRAY_NORMAL, attribute, count * size, &offset);
+		ConvertComponents(format, base, offset, count * 3);
+	}
+#else
+	WriteCall(func);
+#endif
+}
+
+void VertexLoader::WriteColor(int i, u32 attribute, TPipelineFunction func)
+{
+#ifdef USE_VERTEX_LOADER_JIT
+	// Same conversions as VertexLoader_Color.cpp, into EAX.
+	static const int sizes[] = { 2, 3, 4, 2, 3, 4 };
+	const int format = m_VtxAttr.color[i].Comp;
+	int offset;
+	X64Reg base = GetVertexAddr(ARRAY_COLOR + i, attribute, sizes[format], &offset);
+	switch (format)
+	{
+	case FORMAT_16B_565:
+		MOVZX(32, 16, EDX, MDisp(base, offset));
+		ROL(16, R(EDX), Imm8(8));
+		XOR(32, R(EAX), R(EAX));
+		OrShiftedMask(EAX, EDX, -8, 0xF8);
+		OrShiftedMask(EAX, EDX, 5, 0xFC00);
+		OrShiftedMask(EAX, EDX, 19, 0xF80000);
+		OrShiftedMask(EAX, EAX, -5, 0x070007);
+		OrShiftedMask(EAX, EAX, -6, 0x000300);
+		OR(32, R(EAX), Imm32(0xFF000000));
+		break;
+	case FORMAT_24B_888:
+	case FORMAT_32B_888x:
+		MOV(32, R(EAX), MDisp(base, offset));
+		OR(32, R(EAX), Imm32(0xFF000000));
+		break;
+	case FORMAT_16B_4444:
+		MOVZX(32, 16, EDX, MDisp(base, offset));
+		XOR(32, R(EAX), R(EAX));
+		OrShiftedMask(EAX, EDX, 0, 0xF0);
+		OrShiftedMask(EAX, EDX, 12, 0xF000);
+		OrShiftedMask(EAX, EDX, 8, 0xF00000);
+		OrShiftedMask(EAX, EDX, 20, 0xF0000000);
+		OrShiftedMask(EAX, EAX, -4, 0xFFFFFFFF);
+		break;
+	case FORMAT_24B_6666:
+		MOV(32, R(EDX), MDisp(base, offset - 1));
+		BSWAP(32, EDX);
+		XOR(32, R(EAX), R(EAX));
+		OrShiftedMask(EAX, EDX, -16, 0xFC);
+		OrShiftedMask(EAX, EDX, -2, 0xFC00);
+		OrShiftedMask(EAX, EDX, 12, 0xFC0000);
+		OrShiftedMask(EAX, EDX, 26, 0xFC000000);
+		OrShiftedMask(EAX, EAX, -6, 0x03030303);
+		break;
+	case FORMAT_32B_8888:
+		MOV(32, R(EAX), MDisp(base, offset));
+		// Only the direct version kills the alpha, see colElements
+		if (attribute == DIRECT && !m_VtxAttr.color[i].Elements)
+			OR(32, R(EAX), Imm32(0xFF000000));
+		break;
+	}
+	MOV(32, MDisp(dst_reg, m_dst_ofs), R(EAX));
+	m_dst_ofs += 4;
+#else
+	WriteCall(func);
+#endif
+}
+
+void VertexLoader::WriteTexCoord(int i, u32 attribute, TPipelineFunction func)
+{
+#ifdef USE_VERTEX_LOADER_JIT
+	const int format = m_VtxAttr.texCoord[i].Format;
+	if (format > FORMAT_FLOAT)
+	{
+		WriteSetVariable(32, &tcIndex, Imm32(i));
+		WriteCall(func);
+		return;
+	}
+
+	const int elements = m_VtxAttr.texCoord[i].Elements ? 2 : 1;
+	int offset;
+	X64Reg base = GetVertexAddr(ARRAY_TEXCOORD0 + i, attribute, elements * GetComponentSize(format), &offset);
+	if (format != FORMAT_FLOAT)
+		LoadScale(&tcScale[i]);
+	ConvertComponents(format, base, offset, elements);
+#else
+	WriteCall(func);
+#endif
+}
+
 // ARMTODO: This should be done in a better way
 #ifndef _M_GENERIC
 void VertexLoader::WriteGetVariable(int bits, OpArg dest, void *address)
@@ -144,6 +144,30 @@ private:
 
 	void WriteCall(TPipelineFunction);
 
+	// The compiled loader converts the attributes with inline code, and only
+	// calls func for what it doesn't handle. Without the JIT these just add func
+	// to the pipeline.
+	void WriteMtxIdxRead(TPipelineFunction func);
+	void WriteMtxIdxWrite(int i, TPipelineFunction func);
+	void WritePosition(TPipelineFunction func);
+	void WriteNormals(TPipelineFunction func);
+	void WriteColor(int i, u32 attribute, TPipelineFunction func);
+	void WriteTexCoord(int i, u32 attribute, TPipelineFunction func);
+
+#ifdef USE_VERTEX_LOADER_JIT
+	// Offsets from the source and destination registers that the code emitted
+	// so far reads and writes at. The registers are only advanced at the end of
+	// a vertex or before calls.
+	int m_src_ofs;
+	int m_dst_ofs;
+
+	void AdvancePointers();
+	Gen::X64Reg GetVertexAddr(int array, u32 attribute, int direct_size, int* offset);
+	void LoadScale(const float* scale);
+	void ConvertComponents(int format, Gen::X64Reg base, int offset, int count);
+	void OrShiftedMask(Gen::X64Reg dest, Gen::X64Reg src, int shift, u32 mask);
+#endif
+
 #ifndef _M_GENERIC
 	void WriteGetVariable(int bits, Gen::OpArg dest, void *address);
 	void WriteSetVariable(int bits, void *address, Gen::OpArg dest);
@@ -11,6 +11,7 @@
 #include "Core/HW/Memmap.h"
 
 #include "VideoCommon/BPMemory.h"
+#include "VideoCommon/Fifo.h"
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexLoader.h"
@@ -18,6 +19,7 @@
 #include "VideoCommon/VertexManagerBase.h"
 #include "VideoCommon/VertexShaderManager.h"
 #include "VideoCommon/VideoCommon.h"
+#include "VideoCommon/VideoConfig.h"
 
 static int s_attr_dirty;  // bitfield
 
@@ -59,6 +61,7 @@ void Init()
 		map_entry.second = nullptr;
 	}
 	RecomputeCachedArraybases();
+	CopyPreprocessCPStateFromMain();
 }
 
 void Shutdown()
@@ -151,8 +154,202 @@ static VertexLoaderCacheItem RefreshLoader(int vtx_attr_group)
 	return s_VertexLoaders[vtx_attr_group];
 }
 
+namespace
+{
+// One index into a vertex array, as found in the vertex data.
+struct IndexedAttribute
+{
+	int array;
+	u32 vertex_offset;
+	u32 index_size;
+	u32 data_offset; // added to index * stride
+	u32 data_size;
+};
+
+// Describes a vertex format well enough to find its size and the array data it
+// references, without needing a (GPU thread owned) VertexLoader.
+struct VertexLayout
+{
+	u32 size;
+	int num_indexed;
+	IndexedAttribute indexed[14];
+
+	void Add(int array, u32 type, u32 direct_size, u32 data_size, u32 num_indices = 1)
+	{
+		if (type == DIRECT)
+		{
+			size += direct_size;
+		}
+		else if (type == INDEX8 || type == INDEX16)
+		{
+			u32 index_size = (type == INDEX8) ? 1 : 2;
+			for (u32 i = 0; i < num_indices; ++i)
+			{
+				IndexedAttribute& attr = indexed[num_indexed++];
+				attr.array = array;
+				attr.vertex_offset = size;
+				attr.index_size = index_size;
+				attr.data_offset = i * data_size;
+				attr.data_size = data_size;
+				size += index_size;
+			}
+		}
+	}
+};
+}
+
+static u32 GetComponentSize(u32 format)
+{
+	static const u32 sizes[8] = { 1, 1, 2, 2, 4, 0, 0, 0 };
+	return sizes[format & 7];
+}
+
+static u32 GetColorSize(u32 format)
+{
+	static const u32 sizes[8] = { 2, 3, 4, 2, 3, 4, 0, 0 };
+	return sizes[format & 7];
+}
+
+static void GetPreprocessVertexLayout(int vtx_attr_group, VertexLayout* layout)
+{
+	const TVtxDesc& desc = g_preprocess_cp_state.vtx_desc;
+	const VAT& vat = g_preprocess_cp_state.vtx_attr[vtx_attr_group];
+
+	layout->num_indexed = 0;
+	layout->size = 0;
+
+	// Position and texture matrix indices
+	for (int i = 0; i < 9; ++i)
+		layout->size += (desc.Hex >> i) & 1;
+
+	u32 pos_size = GetComponentSize(vat.g0.PosFormat) * (vat.g0.PosElements ? 3 : 2);
+	layout->Add(ARRAY_POSITION, desc.Position, pos_size, pos_size);
+
+	u32 normal_size = GetComponentSize(vat.g0.NormalFormat) * 3;
+	if (vat.g0.NormalElements && vat.g0.NormalIndex3)
+		layout->Add(ARRAY_NORMAL, desc.Normal, normal_size * 3, normal_size, 3);
+	else
+		layout->Add(ARRAY_NORMAL, desc.Normal, normal_size * (vat.g0.NormalElements ? 3 : 1), normal_size * (vat.g0.NormalElements ? 3 : 1));
+
+	u32 color0_size = GetColorSize(vat.g0.Color0Comp);
+	layout->Add(ARRAY_COLOR, desc.Color0, color0_size, color0_size);
+	u32 color1_size = GetColorSize(vat.g0.Color1Comp);
+	layout->Add(ARRAY_COLOR2, desc.Color1, color1_size, color1_size);
+
+	const u32 tc[8] = {
+		desc.Tex0Coord, desc.Tex1Coord, desc.Tex2Coord, desc.Tex3Coord,
+		desc.Tex4Coord, desc.Tex5Coord, desc.Tex6Coord, (u32)((desc.Hex >> 31) & 3)
+	};
+	const u32 tc_format[8] = {
+		vat.g0.Tex0CoordFormat, vat.g1.Tex1CoordFormat, vat.g1.Tex2CoordFormat, vat.g1.Tex3CoordFormat,
+		vat.g1.Tex4CoordFormat, vat.g2.Tex5CoordFormat, vat.g2.Tex6CoordFormat, vat.g2.Tex7CoordFormat
+	};
+	const u32 tc_elements[8] = {
+		vat.g0.Tex0CoordElements, vat.g1.Tex1CoordElements, vat.g1.Tex2CoordElements, vat.g1.Tex3CoordElements,
+		vat.g1.Tex4CoordElements, vat.g2.Tex5CoordElements, vat.g2.Tex6CoordElements, vat.g2.Tex7CoordElements
+	};
+	for (int i = 0; i < 8; ++i)
+	{
+		u32 tc_size = GetComponentSize(tc_format[i]) * (tc_elements[i] ? 2 : 1);
+		layout->Add(ARRAY_TEXCOORD0 + i, tc[i], tc_size, tc_size);
+	}
+}
+
+int GetPreprocessVertexSize(int vtx_attr_group)
+{
+	VertexLayout layout;
+	GetPreprocessVertexLayout(vtx_attr_group, &layout);
+	return layout.size;
+}
+
+void PreprocessVertices(int vtx_attr_group, const u8* data, int count)
+{
+	VertexLayout layout;
+	GetPreprocessVertexLayout(vtx_attr_group, &layout);
+
+	u32 lowest[16], highest[16];
+	for (int i = 0; i < 16; ++i)
+	{
+		lowest[i] = 0xFFFFFFFF;
+		highest[i] = 0;
+	}
+
+	for (int i = 0; i < layout.num_indexed; ++i)
+	{
+		const IndexedAttribute& attr = layout.indexed[i];
+		u32 stride = g_preprocess_cp_state.array_strides[attr.array];
+		const u8* src = data + attr.vertex_offset;
+		for (int v = 0; v < count; ++v, src += layout.size)
+		{
+			u32 index = (attr.index_size == 1) ? *src : Common::swap16(src);
+			u32 start = index * stride + attr.data_offset;
+			lowest[attr.array] = std::min(lowest[attr.array], start);
+			highest[attr.array] = std::max(highest[attr.array], start + attr.data_size);
+		}
+	}
+
+	u32 mask = 0;
+	for (int i = 0; i < 16; ++i)
+	{
+		if (highest[i] > lowest[i])
+			mask |= 1 << i;
+	}
+	PushFifoAuxBuffer(&mask, sizeof(mask));
+
+	for (int i = 0; i < 16; ++i)
+	{
+		if (!(mask & (1 << i)))
+			continue;
+
+		u32 range[2] = { lowest[i], highest[i] - lowest[i] };
+		u32 address = g_preprocess_cp_state.array_bases[i] + range[0];
+		u8* src = Memory::GetPointer(address);
+		// Huge or unmapped ranges are left to the GPU thread to read from RAM.
+		if (src == nullptr || range[1] > FIFO_SIZE / 4 ||
+		    Memory::GetPointer(address + range[1] - 1) != src + range[1] - 1)
+			range[1] = 0;
+
+		PushFifoAuxBuffer(range, sizeof(range));
+		PushFifoAuxBuffer(src, range[1]);
+	}
+}
+
+// Points cached_arraybases at the copies PreprocessVertices made for this
+// primitive. The previous pointers are saved to saved_bases.
+static void PopPreprocessedArrays(u8** saved_bases)
+{
+	u32 mask = *(u32*)PopFifoAuxBuffer(sizeof(u32));
+	for (int i = 0; i < 16; ++i)
+	{
+		saved_bases[i] = cached_arraybases[i];
+		if (!(mask & (1 << i)))
+			continue;
+
+		u32* range = (u32*)PopFifoAuxBuffer(2 * sizeof(u32));
+		u32 offset = range[0];
+		u32 size = range[1];
+		u8* copy = (u8*)PopFifoAuxBuffer(size);
+		if (size)
+			cached_arraybases[i] = copy - offset;
+	}
+}
+
+void SkipVertices(int vtx_attr_group, int count)
+{
+	if (g_use_deterministic_gpu_thread)
+	{
+		u8* saved_bases[16];
+		PopPreprocessedArrays(saved_bases);
+	}
+	DataSkip(count * GetVertexSize(vtx_attr_group));
+}
+
 void RunVertices(int vtx_attr_group, int primitive, int count)
 {
+	u8* saved_bases[16];
+	if (g_use_deterministic_gpu_thread)
+		PopPreprocessedArrays(saved_bases);
+
 	if (!count)
 		return;
 	auto loader = RefreshLoader(vtx_attr_group);
@@ -161,6 +358,8 @@ void RunVertices(int vtx_attr_group, int primitive, int count)
 	{
 		// if cull mode is CULL_ALL, ignore triangles and quads
 		DataSkip(count * loader.first->GetVertexSize());
+		if (g_use_deterministic_gpu_thread)
+			std::copy(saved_bases, saved_bases + 16, cached_arraybases);
 		return;
 	}
 
@@ -171,13 +370,90 @@ void RunVertices(int vtx_attr_group, int primitive, int count)
 
 	VertexManager::PrepareForAdditionalData(primitive, count,
 			loader.first->GetNativeVertexDeclaration().stride);
+	VertexShaderManager::TrackXFReads(loader.first->GetNativeComponents());
 
 	loader.first->RunVertices(g_VtxAttr[vtx_attr_group], primitive, count);
 
 	IndexGenerator::AddIndices(primitive, count);
 
+	if (g_use_deterministic_gpu_thread)
+		std::copy(saved_bases, saved_bases + 16, cached_arraybases);
+
+	ADDSTAT(stats.thisFrame.numPrims, count);
+	INCSTAT(stats.thisFrame.numPrimitiveJoins);
+}
+
+// Whether any attribute of the vertex descriptor is read from an array in RAM.
+static bool HasIndexedAttributes(const TVtxDesc& vtx_desc)
+{
+	// Position to Tex7Coord are 2-bit fields starting at bit 9, indexed if the upper bit is set.
+	for (int i = 0; i < 12; ++i)
+	{
+		if ((vtx_desc.Hex >> (9 + 2 * i)) & 2)
+			return true;
+	}
+	return false;
+}
+
+void RunVertices(int vtx_attr_group, int primitive, int count, ConvertedVertices* converted)
+{
+	converted->loader = nullptr;
+	converted->data.clear();
+
+	RunVertices(vtx_attr_group, primitive, count);
+
+	// Vertices loaded from arrays depend on RAM the display list cache doesn't
+	// check, and the bounding box is computed while loading.
+	if (!count || HasIndexedAttributes(g_VtxDesc) || g_ActiveConfig.bUseBBox ||
+	    (bpmem.genMode.cullmode == GenMode::CULL_ALL && primitive < 5))
+	{
+		return;
+	}
+
+	const VertexLoader* loader = s_VertexLoaders[vtx_attr_group].first;
+	const u32 size = count * loader->GetNativeVertexDeclaration().stride;
+	converted->loader = loader;
+	converted->vat[0] = g_VtxAttr[vtx_attr_group].g0.Hex;
+	converted->vat[1] = g_VtxAttr[vtx_attr_group].g1.Hex;
+	converted->vat[2] = g_VtxAttr[vtx_attr_group].g2.Hex;
+	converted->matrix_index[0] = MatrixIndexA.Hex;
+	converted->matrix_index[1] = MatrixIndexB.Hex;
+	converted->data.assign(VertexManager::s_pCurBufferPointer - size, VertexManager::s_pCurBufferPointer);
+}
+
+bool RunConvertedVertices(int vtx_attr_group, int primitive, int count, const ConvertedVertices& converted)
+{
+	// if cull mode is CULL_ALL, ignore triangles and quads
+	if (bpmem.genMode.cullmode == GenMode::CULL_ALL && primitive < 5)
+		return true;
+
+	auto loader = RefreshLoader(vtx_attr_group);
+	if (loader.first != converted.loader ||
+	    g_VtxAttr[vtx_attr_group].g0.Hex != converted.vat[0] ||
+	    g_VtxAttr[vtx_attr_group].g1.Hex != converted.vat[1] ||
+	    g_VtxAttr[vtx_attr_group].g2.Hex != converted.vat[2] ||
+	    MatrixIndexA.Hex != converted.matrix_index[0] ||
+	    MatrixIndexB.Hex != converted.matrix_index[1])
+	{
+		return false;
+	}
+
+	if (loader.second != s_current_vtx_fmt)
+		VertexManager::Flush();
+	s_current_vtx_fmt = loader.second;
+
+	VertexManager::PrepareForAdditionalData(primitive, count,
+			loader.first->GetNativeVertexDeclaration().stride);
+	VertexShaderManager::TrackXFReads(loader.first->GetNativeComponents());
+
+	memcpy(VertexManager::s_pCurBufferPointer, converted.data.data(), converted.data.size());
+	VertexManager::s_pCurBufferPointer += converted.data.size();
+
+	IndexGenerator::AddIndices(primitive, count);
+
 	ADDSTAT(stats.thisFrame.numPrims, count);
 	INCSTAT(stats.thisFrame.numPrimitiveJoins);
+	return true;
 }
 
 int GetVertexSize(int vtx_attr_group)
@@ -246,6 +522,51 @@ void LoadCPReg(u32 sub_cmd, u32 value)
 	}
 }
 
+void LoadCPRegPreprocess(u32 sub_cmd, u32 value)
+{
+	CPState& state = g_preprocess_cp_state;
+	switch (sub_cmd & 0xF0)
+	{
+	case 0x50:
+		state.vtx_desc.Hex &= ~0x1FFFF;  // keep the Upper bits
+		state.vtx_desc.Hex |= value;
+		break;
+
+	case 0x60:
+		state.vtx_desc.Hex &= 0x1FFFF;  // keep the lower 17Bits
+		state.vtx_desc.Hex |= (u64)value << 17;
+		break;
+
+	case 0x70:
+		state.vtx_attr[sub_cmd & 7].g0.Hex = value;
+		break;
+
+	case 0x80:
+		state.vtx_attr[sub_cmd & 7].g1.Hex = value;
+		break;
+
+	case 0x90:
+		state.vtx_attr[sub_cmd & 7].g2.Hex = value;
+		break;
+
+	case 0xA0:
+		state.array_bases[sub_cmd & 0xF] = value;
+		break;
+
+	case 0xB0:
+		state.array_strides[sub_cmd & 0xF] = value & 0xFF;
+		break;
+	}
+}
+
+void CopyPreprocessCPStateFromMain()
+{
+	std::copy(arraybases, arraybases + 16, g_preprocess_cp_state.array_bases);
+	std::copy(arraystrides, arraystrides + 16, g_preprocess_cp_state.array_strides);
+	g_preprocess_cp_state.vtx_desc = g_VtxDesc;
+	std::copy(g_VtxAttr, g_VtxAttr + 8, g_preprocess_cp_state.vtx_attr);
+}
+
 void FillCPMemoryArray(u32 *memory)
 {
 	memory[0x30] = MatrixIndexA.Hex;
@@ -5,6 +5,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "Common/Common.h"
 #include "VideoCommon/NativeVertexFormat.h"
@@ -18,6 +19,25 @@ namespace VertexLoaderManager
 
 	int GetVertexSize(int vtx_attr_group);
 	void RunVertices(int vtx_attr_group, int primitive, int count);
+	void SkipVertices(int vtx_attr_group, int count);
+
+	// Used by the display list cache: vertices converted by RunVertices, along
+	// with the state they were converted with. They can be replayed without
+	// running the vertex loader for as long as that state doesn't change.
+	struct ConvertedVertices
+	{
+		const void* loader; // nullptr if the vertices can't be replayed
+		u32 vat[3];
+		u32 matrix_index[2];
+		std::vector<u8> data;
+	};
+	void RunVertices(int vtx_attr_group, int primitive, int count, ConvertedVertices* converted);
+	// Returns false if the state changed, in which case nothing is drawn.
+	bool RunConvertedVertices(int vtx_attr_group, int primitive, int count, const ConvertedVertices& converted);
+
+	// Used by the FIFO preprocessor (deterministic GPU thread) on the CPU thread.
+	int GetPreprocessVertexSize(int vtx_attr_group);
+	void PreprocessVertices(int vtx_attr_group, const u8* data, int count);
 
 	// For debugging
 	void AppendListToString(std::string *dest);
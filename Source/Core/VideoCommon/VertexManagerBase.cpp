@@ -231,6 +231,7 @@ void VertexManager::Flush()
 
 	GFX_DEBUGGER_PAUSE_AT(NEXT_FLUSH, true);
 
+	VertexShaderManager::ResetXFReads();
 	IsFlushed = true;
 }
 
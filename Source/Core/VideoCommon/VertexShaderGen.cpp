@@ -63,7 +63,7 @@ static inline void GenerateVertexShader(T& out, u32 components, API_TYPE api_typ
 	vertex_shader_uid_data& uid_data = (&out.template GetUidData<vertex_shader_uid_data>() != nullptr)
 											? out.template GetUidData<vertex_shader_uid_data>() : dummy_data;
 
-	out.SetBuffer(text);
+	out.SetBuffer(text, sizeof(text));
 	const bool is_writing_shadercode = (out.GetBuffer() != nullptr);
 #ifndef ANDROID
 	locale_t locale;
@@ -75,9 +75,6 @@ static inline void GenerateVertexShader(T& out, u32 components, API_TYPE api_typ
 	}
 #endif
 
-	if (is_writing_shadercode)
-		text[sizeof(text) - 1] = 0x7C;  // canary
-
 	_assert_(bpmem.genMode.numtexgens == xfmem.numTexGen.numTexGens);
 	_assert_(bpmem.genMode.numcolchans == xfmem.numChan.numColorChans);
 
@@ -452,8 +449,8 @@ static inline void GenerateVertexShader(T& out, u32 components, API_TYPE api_typ
 
 	if (is_writing_shadercode)
 	{
-		if (text[sizeof(text) - 1] != 0x7C)
-			PanicAlert("VertexShader generator - buffer too small, canary has been eaten!");
+		if (out.HasOverflowed())
+			PanicAlert("VertexShader generator - buffer too small, the shader has been cut off!");
 
 #ifndef ANDROID
 		uselocale(old_locale); // restore locale
@@ -465,6 +462,7 @@ static inline void GenerateVertexShader(T& out, u32 components, API_TYPE api_typ
 void GetVertexShaderUid(VertexShaderUid& object, u32 components, API_TYPE api_type)
 {
 	GenerateVertexShader<VertexShaderUid>(object, components, api_type);
+	object.CalculateHash();
 }
 
 void GenerateVertexShaderCode(VertexShaderCode& object, u32 components, API_TYPE api_type)
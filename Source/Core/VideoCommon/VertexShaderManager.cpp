@@ -2,6 +2,7 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cmath>
 #include <sstream>
 
@@ -28,6 +29,10 @@ static int nNormalMatricesChanged[2]; // min,max
 static int nPostTransformMatricesChanged[2]; // min,max
 static int nLightsChanged[2]; // min,max
 
+// The parts of XF memory read by the vertices since the last flush, with a bit per 4 words.
+// XF memory above the lights isn't used by the shaders.
+static u64 s_xf_reads[(XFMEM_LIGHTS_END / 4 + 63) / 64];
+
 static Matrix44 s_viewportCorrection;
 static Matrix33 s_viewRotationMatrix;
 static Matrix33 s_viewInvRotationMatrix;
@@ -626,6 +631,87 @@ void VertexShaderManager::InvalidateXFRange(int start, int end)
 	}
 }
 
+static void MarkXFRead(u32 start, u32 end)
+{
+	for (u32 i = start / 4; i < (end + 3) / 4; ++i)
+		s_xf_reads[i / 64] |= 1ULL << (i % 64);
+}
+
+void VertexShaderManager::TrackXFReads(u32 components)
+{
+	// Matrix indices in the vertices can point anywhere
+	if (components & VB_HAS_POSMTXIDX)
+	{
+		MarkXFRead(XFMEM_POSMATRICES, XFMEM_POSMATRICES_END);
+		MarkXFRead(XFMEM_NORMALMATRICES, XFMEM_NORMALMATRICES_END);
+	}
+	else
+	{
+		const u32 normal = XFMEM_NORMALMATRICES + (MatrixIndexA.PosNormalMtxIdx & 31) * 3;
+		MarkXFRead(MatrixIndexA.PosNormalMtxIdx * 4, MatrixIndexA.PosNormalMtxIdx * 4 + 12);
+		MarkXFRead(normal, normal + 9);
+	}
+
+	const u32 tex_matrices[8] =
+	{
+		MatrixIndexA.Tex0MtxIdx, MatrixIndexA.Tex1MtxIdx, MatrixIndexA.Tex2MtxIdx, MatrixIndexA.Tex3MtxIdx,
+		MatrixIndexB.Tex4MtxIdx, MatrixIndexB.Tex5MtxIdx, MatrixIndexB.Tex6MtxIdx, MatrixIndexB.Tex7MtxIdx
+	};
+	u32 light_mask = 0;
+	for (u32 i = 0; i < xfmem.numTexGen.numTexGens; ++i)
+	{
+		if (components & (VB_HAS_TEXMTXIDX0 << i))
+			MarkXFRead(XFMEM_POSMATRICES, XFMEM_POSMATRICES_END);
+		else
+			MarkXFRead(tex_matrices[i] * 4, tex_matrices[i] * 4 + 12);
+
+		if (xfmem.dualTexTrans.enabled)
+		{
+			for (u32 row = 0; row < 3; ++row)
+			{
+				const u32 post = XFMEM_POSTMATRICES + ((xfmem.postMtxInfo[i].index + row) & 0x3f) * 4;
+				MarkXFRead(post, post + 4);
+			}
+		}
+
+		if (xfmem.texMtxInfo[i].texgentype == XF_TEXGEN_EMBOSS_MAP)
+			light_mask |= 1 << xfmem.texMtxInfo[i].embosslightshift;
+	}
+
+	for (int i = 0; i < 2; ++i)
+		light_mask |= xfmem.color[i].GetFullLightMask() | xfmem.alpha[i].GetFullLightMask();
+	for (int i = 0; i < 8; ++i)
+	{
+		if (light_mask & (1 << i))
+			MarkXFRead(XFMEM_LIGHTS + i * 0x10, XFMEM_LIGHTS + (i + 1) * 0x10);
+	}
+}
+
+bool VertexShaderManager::IsXFRangeRead(u32 start, u32 end)
+{
+	end = std::min<u32>(end, XFMEM_LIGHTS_END);
+	for (u32 i = start / 4; i < (end + 3) / 4; ++i)
+	{
+		if (s_xf_reads[i / 64] & (1ULL << (i % 64)))
+			return true;
+	}
+
+	for (u64 reads : s_xf_reads)
+	{
+		if (reads)
+		{
+			INCSTAT(stats.thisFrame.numFlushesAvoided);
+			break;
+		}
+	}
+	return false;
+}
+
+void VertexShaderManager::ResetXFReads()
+{
+	memset(s_xf_reads, 0, sizeof(s_xf_reads));
+}
+
 void VertexShaderManager::SetTexMatrixChangedA(u32 Value)
 {
 	if (MatrixIndexA.Hex != Value)
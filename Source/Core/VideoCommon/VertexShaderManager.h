@@ -24,6 +24,14 @@ public:
 	static void SetConstants();
 
 	static void InvalidateXFRange(int start, int end);
+
+	// Records which parts of XF memory vertices with the given components read
+	// under the current state, until the next flush.
+	// Writes to other parts don't have to flush the pending vertices.
+	static void TrackXFReads(u32 components);
+	static bool IsXFRangeRead(u32 start, u32 end);
+	static void ResetXFReads();
+
 	static void SetTexMatrixChangedA(u32 value);
 	static void SetTexMatrixChangedB(u32 value);
 	static void SetViewportChanged();
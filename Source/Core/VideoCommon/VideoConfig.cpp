@@ -74,6 +74,7 @@ void VideoConfig::Load(const std::string& ini_file)
 	settings->Get("AnaglyphFocalAngle", &iAnaglyphFocalAngle, 0);
 	settings->Get("EnablePixelLighting", &bEnablePixelLighting, 0);
 	settings->Get("FastDepthCalc", &bFastDepthCalc, true);
+	settings->Get("BackgroundShaderCompiling", &bBackgroundShaderCompiling, false);
 	settings->Get("MSAA", &iMultisampleMode, 0);
 	settings->Get("EFBScale", &iEFBScale, (int) SCALE_1X); // native
 	settings->Get("DstAlphaPass", &bDstAlphaPass, false);
@@ -97,6 +98,7 @@ void VideoConfig::Load(const std::string& ini_file)
 	hacks->Get("EFBScaledCopy", &bCopyEFBScaled, true);
 	hacks->Get("EFBCopyCacheEnable", &bEFBCopyCacheEnable, false);
 	hacks->Get("EFBEmulateFormatChanges", &bEFBEmulateFormatChanges, false);
+	hacks->Get("DlistCachingEnable", &bDlistCachingEnable, false);
 
 	// Load common settings
 	iniFile.Load(File::GetUserPath(F_DOLPHINCONFIG_IDX));
@@ -191,6 +193,7 @@ void VideoConfig::GameIniLoad()
 	CHECK_SETTING("Video_Hacks", "EFBScaledCopy", bCopyEFBScaled);
 	CHECK_SETTING("Video_Hacks", "EFBCopyCacheEnable", bEFBCopyCacheEnable);
 	CHECK_SETTING("Video_Hacks", "EFBEmulateFormatChanges", bEFBEmulateFormatChanges);
+	CHECK_SETTING("Video_Hacks", "DlistCachingEnable", bDlistCachingEnable);
 
 	CHECK_SETTING("Video", "ProjectionHack", iPhackvalue[0]);
 	CHECK_SETTING("Video", "PH_SZNear", iPhackvalue[1]);
@@ -244,6 +247,7 @@ void VideoConfig::Save(const std::string& ini_file)
 	settings->Set("AnaglyphFocalAngle", iAnaglyphFocalAngle);
 	settings->Set("EnablePixelLighting", bEnablePixelLighting);
 	settings->Set("FastDepthCalc", bFastDepthCalc);
+	settings->Set("BackgroundShaderCompiling", bBackgroundShaderCompiling);
 	settings->Set("ShowEFBCopyRegions", bShowEFBCopyRegions);
 	settings->Set("MSAA", iMultisampleMode);
 	settings->Set("EFBScale", iEFBScale);
@@ -268,6 +272,7 @@ void VideoConfig::Save(const std::string& ini_file)
 	hacks->Set("EFBScaledCopy", bCopyEFBScaled);
 	hacks->Set("EFBCopyCacheEnable", bEFBCopyCacheEnable);
 	hacks->Set("EFBEmulateFormatChanges", bEFBEmulateFormatChanges);
+	hacks->Set("DlistCachingEnable", bDlistCachingEnable);
 
 	iniFile.Save(ini_file);
 }
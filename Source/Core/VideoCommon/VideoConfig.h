@@ -109,6 +109,7 @@ struct VideoConfig final
 	bool bEFBCopyEnable;
 	bool bEFBCopyCacheEnable;
 	bool bEFBEmulateFormatChanges;
+	bool bDlistCachingEnable;
 	bool bCopyEFBToTexture;
 	bool bCopyEFBScaled;
 	int iSafeTextureCache_ColorSamples;
@@ -118,6 +119,7 @@ struct VideoConfig final
 	bool bUseBBox;
 	bool bEnablePixelLighting;
 	bool bFastDepthCalc;
+	bool bBackgroundShaderCompiling;
 	int iLog; // CONF_ bits
 	int iSaveTargetId; // TODO: Should be dropped
 
@@ -275,3 +275,4 @@ extern XFMemory xfmem;
 
 void LoadXFReg(u32 transferSize, u32 address, u32 *pData);
 void LoadIndexedXF(u32 val, int array);
+void PreprocessIndexedXF(u32 val, int refarray);
@@ -5,6 +5,7 @@
 #include "Common/Common.h"
 #include "Core/HW/Memmap.h"
 #include "VideoCommon/CPMemory.h"
+#include "VideoCommon/Fifo.h"
 #include "VideoCommon/PixelShaderManager.h"
 #include "VideoCommon/VertexManagerBase.h"
 #include "VideoCommon/VertexShaderManager.h"
@@ -13,7 +14,9 @@
 
 static void XFMemWritten(u32 transferSize, u32 baseAddress)
 {
-	VertexManager::Flush();
+	// Matrices and lights are often loaded into slots the pending vertices don't use
+	if (VertexShaderManager::IsXFRangeRead(baseAddress, baseAddress + transferSize))
+		VertexManager::Flush();
 	VertexShaderManager::InvalidateXFRange(baseAddress, baseAddress + transferSize);
 }
 
@@ -247,7 +250,11 @@ void LoadIndexedXF(u32 val, int refarray)
 	//load stuff from array to address in xf mem
 
 	u32* currData = (u32*)(&xfmem) + address;
-	u32* newData = (u32*)Memory::GetPointer(arraybases[refarray] + arraystrides[refarray] * index);
+	u32* newData;
+	if (g_use_deterministic_gpu_thread)
+		newData = (u32*)PopFifoAuxBuffer(size * sizeof(u32));
+	else
+		newData = (u32*)Memory::GetPointer(arraybases[refarray] + arraystrides[refarray] * index);
 	bool changed = false;
 	for (int i = 0; i < size; ++i)
 	{
@@ -264,3 +271,19 @@ void LoadIndexedXF(u32 val, int refarray)
 			currData[i] = Common::swap32(newData[i]);
 	}
 }
+
+void PreprocessIndexedXF(u32 val, int refarray)
+{
+	int index = val >> 16;
+	int size = ((val >> 12) & 0xF) + 1;
+
+	u32 address = g_preprocess_cp_state.array_bases[refarray] + g_preprocess_cp_state.array_strides[refarray] * index;
+	u32* new_data = (u32*)Memory::GetPointer(address);
+	if (new_data == nullptr || Memory::GetPointer(address + size * sizeof(u32) - 1) != (u8*)new_data + size * sizeof(u32) - 1)
+	{
+		// Keep the aux buffer in step with the GPU thread anyway.
+		static const u32 zeroes[16] = {};
+		new_data = (u32*)zeroes;
+	}
+	PushFifoAuxBuffer(new_data, size * sizeof(u32));
+}
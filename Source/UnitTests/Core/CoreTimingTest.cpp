@@ -0,0 +1,178 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "Common/ChunkFile.h"
+#include "Core/CoreTiming.h"
+#include "Core/PowerPC/PowerPC.h"
+
+namespace
+{
+std::vector<u64> s_fired;
+int s_reschedule_type;
+u64 s_callback_count;
+
+void RecordCallback(u64 userdata, int cycles_late)
+{
+	s_fired.push_back(userdata);
+}
+
+void CountCallback(u64 userdata, int cycles_late)
+{
+	s_callback_count++;
+}
+
+void RescheduleCallback(u64 userdata, int cycles_late)
+{
+	s_callback_count++;
+	CoreTiming::ScheduleEvent((int)userdata - cycles_late, s_reschedule_type, userdata);
+}
+}
+
+class CoreTimingTest : public testing::Test
+{
+protected:
+	virtual void SetUp() override
+	{
+		s_fired.clear();
+		s_callback_count = 0;
+		CoreTiming::Init();
+	}
+
+	virtual void TearDown() override
+	{
+		CoreTiming::Shutdown();
+	}
+
+	// Pretends the CPU ran until the next event (or the end of the maximum slice).
+	void AdvanceSlice()
+	{
+		PowerPC::ppcState.downcount = 0;
+		CoreTiming::Advance();
+	}
+
+	// Runs slices until the timer reaches ticks. Doesn't stop early, so ticks
+	// should be an event time.
+	void AdvanceTo(u64 ticks)
+	{
+		// Run nothing, but pick up events scheduled since the last slice.
+		PowerPC::ppcState.downcount = CoreTiming::slicelength;
+		CoreTiming::Advance();
+
+		while (CoreTiming::GetTicks() < ticks)
+			AdvanceSlice();
+	}
+};
+
+TEST_F(CoreTimingTest, FiresInTimeOrder)
+{
+	int type = CoreTiming::RegisterEvent("Record", RecordCallback);
+	CoreTiming::ScheduleEvent(300, type, 3);
+	CoreTiming::ScheduleEvent(100, type, 1);
+	CoreTiming::ScheduleEvent(200, type, 2);
+
+	AdvanceTo(100);
+	EXPECT_EQ(std::vector<u64>({ 1 }), s_fired);
+	AdvanceTo(400);
+	EXPECT_EQ(std::vector<u64>({ 1, 2, 3 }), s_fired);
+}
+
+TEST_F(CoreTimingTest, SameTimeKeepsScheduleOrder)
+{
+	int type = CoreTiming::RegisterEvent("Record", RecordCallback);
+	for (u64 i = 0; i < 32; ++i)
+		CoreTiming::ScheduleEvent(100, type, i);
+	AdvanceTo(100);
+
+	ASSERT_EQ(32u, s_fired.size());
+	for (u64 i = 0; i < 32; ++i)
+		EXPECT_EQ(i, s_fired[i]);
+}
+
+TEST_F(CoreTimingTest, RemoveEvent)
+{
+	int removed = CoreTiming::RegisterEvent("Removed", RecordCallback);
+	int kept = CoreTiming::RegisterEvent("Kept", RecordCallback);
+	CoreTiming::ScheduleEvent(100, removed, 1);
+	CoreTiming::ScheduleEvent(200, kept, 2);
+	CoreTiming::ScheduleEvent(300, removed, 3);
+	EXPECT_TRUE(CoreTiming::IsScheduled(removed));
+
+	CoreTiming::RemoveEvent(removed);
+	EXPECT_FALSE(CoreTiming::IsScheduled(removed));
+	EXPECT_TRUE(CoreTiming::IsScheduled(kept));
+
+	// Events scheduled after the removal still fire.
+	CoreTiming::ScheduleEvent(250, removed, 4);
+	AdvanceTo(400);
+	EXPECT_EQ(std::vector<u64>({ 2, 4 }), s_fired);
+	EXPECT_FALSE(CoreTiming::IsScheduled(kept));
+}
+
+TEST_F(CoreTimingTest, SavestateRoundTrip)
+{
+	int type = CoreTiming::RegisterEvent("Record", RecordCallback);
+	CoreTiming::ScheduleEvent(200, type, 2);
+	CoreTiming::ScheduleEvent(100, type, 1);
+	CoreTiming::ScheduleEvent(300, type, 3);
+	CoreTiming::RemoveEvent(type);
+	CoreTiming::ScheduleEvent(500, type, 5);
+	CoreTiming::ScheduleEvent(400, type, 4);
+
+	u8* ptr = nullptr;
+	PointerWrap p_measure(&ptr, PointerWrap::MODE_MEASURE);
+	CoreTiming::DoState(p_measure);
+	size_t size = (size_t)ptr;
+
+	std::vector<u8> buffer(size);
+	ptr = buffer.data();
+	PointerWrap p_write(&ptr, PointerWrap::MODE_WRITE);
+	CoreTiming::DoState(p_write);
+
+	CoreTiming::ClearPendingEvents();
+	CoreTiming::ScheduleEvent(50, type, 0);
+
+	ptr = buffer.data();
+	PointerWrap p_read(&ptr, PointerWrap::MODE_READ);
+	CoreTiming::DoState(p_read);
+	EXPECT_EQ(size, (size_t)(ptr - buffer.data()));
+
+	AdvanceTo(600);
+	EXPECT_EQ(std::vector<u64>({ 4, 5 }), s_fired);
+}
+
+// Not a correctness test: reports scheduler throughput with a queue
+// depth similar to what a running game keeps.
+// Run it with --gtest_also_run_disabled_tests.
+TEST_F(CoreTimingTest, DISABLED_Benchmark)
+{
+	const int num_periodic = 32;
+	const u64 num_one_shot = 1000000;
+
+	s_reschedule_type = CoreTiming::RegisterEvent("Periodic", RescheduleCallback);
+	int one_shot = CoreTiming::RegisterEvent("OneShot", CountCallback);
+	for (int i = 0; i < num_periodic; ++i)
+		CoreTiming::ScheduleEvent(1000 + i * 97, s_reschedule_type, 1000 + i * 97);
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (u64 i = 0; i < num_one_shot; ++i)
+	{
+		CoreTiming::ScheduleEvent((int)(i % 5000), one_shot);
+		if (i % 8 == 0)
+			AdvanceSlice();
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+
+	double seconds = std::chrono::duration<double>(end - start).count();
+	printf("Scheduled %llu events and ran %llu callbacks in %.3f s (%.1f M events/s)\n",
+	       (unsigned long long)num_one_shot, (unsigned long long)s_callback_count,
+	       seconds, num_one_shot / seconds / 1000000.0);
+	EXPECT_GT(s_callback_count, 0u);
+
+	CoreTiming::ClearPendingEvents();
+}
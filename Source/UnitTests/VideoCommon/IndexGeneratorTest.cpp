@@ -0,0 +1,169 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "Common/Common.h"
+#include "VideoCommon/IndexGenerator.h"
+#include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/VideoConfig.h"
+
+#include <gtest/gtest.h>  // NOLINT
+
+namespace
+{
+const u16 RESTART = 0xFFFF;
+
+void Triangle(std::vector<u16>* out, bool pr, u32 a, u32 b, u32 c)
+{
+	out->push_back(a);
+	out->push_back(b);
+	out->push_back(c);
+	if (pr)
+		out->push_back(RESTART);
+}
+
+// The triangles each primitive stands for, one at a time.
+std::vector<u16> Reference(int primitive, bool pr, u32 num_verts, u32 index)
+{
+	std::vector<u16> out;
+	switch (primitive)
+	{
+	case GX_DRAW_QUADS:
+	case GX_DRAW_QUADS_2:
+	{
+		u32 i = 3;
+		for (; i < num_verts; i += 4)
+		{
+			if (pr)
+			{
+				out.insert(out.end(), { (u16)(index + i - 2), (u16)(index + i - 1), (u16)(index + i - 3), (u16)(index + i), RESTART });
+			}
+			else
+			{
+				Triangle(&out, pr, index + i - 3, index + i - 2, index + i - 1);
+				Triangle(&out, pr, index + i - 3, index + i - 1, index + i);
+			}
+		}
+		if (i == num_verts)
+			Triangle(&out, pr, index + i - 3, index + i - 2, index + i - 1);
+		break;
+	}
+	case GX_DRAW_TRIANGLES:
+		for (u32 i = 2; i < num_verts; i += 3)
+			Triangle(&out, pr, index + i - 2, index + i - 1, index + i);
+		break;
+	case GX_DRAW_TRIANGLE_STRIP:
+		if (pr)
+		{
+			for (u32 i = 0; i < num_verts; ++i)
+				out.push_back(index + i);
+			out.push_back(RESTART);
+		}
+		else
+		{
+			for (u32 i = 2; i < num_verts; ++i)
+			{
+				if (i % 2)
+					Triangle(&out, pr, index + i - 2, index + i, index + i - 1);
+				else
+					Triangle(&out, pr, index + i - 2, index + i - 1, index + i);
+			}
+		}
+		break;
+	case GX_DRAW_TRIANGLE_FAN:
+	{
+		u32 i = 2;
+		if (pr)
+		{
+			// Pairs of triangles as strips
+			for (; i + 3 <= num_verts; i += 3)
+				out.insert(out.end(), { (u16)(index + i - 1), (u16)(index + i), (u16)index, (u16)(index + i + 1), (u16)(index + i + 2), RESTART });
+			for (; i + 2 <= num_verts; i += 2)
+				out.insert(out.end(), { (u16)(index + i - 1), (u16)(index + i), (u16)index, (u16)(index + i + 1), RESTART });
+		}
+		for (; i < num_verts; ++i)
+			Triangle(&out, pr, index, index + i - 1, index + i);
+		break;
+	}
+	}
+	return out;
+}
+
+const int s_triangle_primitives[] = {
+	GX_DRAW_QUADS, GX_DRAW_TRIANGLES, GX_DRAW_TRIANGLE_STRIP, GX_DRAW_TRIANGLE_FAN,
+};
+const char* const s_primitive_names[] = { "quads", "triangles", "strip", "fan" };
+}
+
+class IndexGeneratorTest : public testing::TestWithParam<bool>
+{
+protected:
+	virtual void SetUp() override
+	{
+		g_Config.backend_info.bSupportsPrimitiveRestart = GetParam();
+		IndexGenerator::Init();
+	}
+
+	// Generates the indices of one primitive, after base vertices.
+	std::vector<u16> Generate(int primitive, u32 num_verts, u32 base)
+	{
+		std::vector<u16> buffer(num_verts * 4 + 1);
+		IndexGenerator::Start(buffer.data());
+		if (base)
+			IndexGenerator::AddIndices(GX_DRAW_POINTS, base);
+		const u32 start = IndexGenerator::GetIndexLen();
+		IndexGenerator::AddIndices(primitive, num_verts);
+		return std::vector<u16>(buffer.begin() + start, buffer.begin() + IndexGenerator::GetIndexLen());
+	}
+};
+
+TEST_P(IndexGeneratorTest, MatchesReference)
+{
+	for (int p = 0; p < 4; ++p)
+	{
+		const int primitive = s_triangle_primitives[p];
+		for (u32 num_verts = 0; num_verts < 100; ++num_verts)
+		{
+			for (u32 base : { 0, 5 })
+			{
+				ASSERT_EQ(Reference(primitive, GetParam(), num_verts, base), Generate(primitive, num_verts, base))
+					<< s_primitive_names[p] << ", " << num_verts << " vertices after " << base;
+			}
+		}
+	}
+}
+
+// Not a correctness test: reports how fast indices are generated for long primitives.
+// Run it with --gtest_also_run_disabled_tests.
+TEST_P(IndexGeneratorTest, DISABLED_Benchmark)
+{
+	const u32 num_verts = 60000;
+	const int iterations = 200;
+	std::vector<u16> buffer(num_verts * 4);
+
+	for (int p = 0; p < 4; ++p)
+	{
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < iterations; ++i)
+		{
+			IndexGenerator::Start(buffer.data());
+			IndexGenerator::AddIndices(s_triangle_primitives[p], num_verts);
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+
+		double seconds = std::chrono::duration<double>(end - start).count();
+		printf("%-9s %s: %8.1f MVertex/s\n", s_primitive_names[p], GetParam() ? "restart" : "list   ",
+			(double)num_verts * iterations / seconds / 1000000.0);
+	}
+}
+
+// The generator function this defines has no declaration of its own: keep it
+// file-local.
+namespace
+{
+INSTANTIATE_TEST_CASE_P(PrimitiveRestart, IndexGeneratorTest, testing::Bool());
+}
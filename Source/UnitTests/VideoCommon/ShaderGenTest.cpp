@@ -0,0 +1,157 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+
+#include "Common/Common.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/PixelShaderGen.h"
+#include "VideoCommon/ShaderGenCommon.h"
+#include "VideoCommon/VertexShaderGen.h"
+#include "VideoCommon/XFMemory.h"
+
+#include <gtest/gtest.h>  // NOLINT
+
+namespace
+{
+// Formats with ShaderCode and with snprintf, which must agree.
+template <typename... Args>
+void ExpectSameAsSnprintf(const char* fmt, Args... args)
+{
+	char expected[256];
+	snprintf(expected, sizeof(expected), fmt, args...);
+
+	char buffer[256];
+	ShaderCode code;
+	code.SetBuffer(buffer, sizeof(buffer));
+	code.Write(fmt, args...);
+	EXPECT_STREQ(expected, code.GetBuffer()) << "format: " << fmt;
+	EXPECT_FALSE(code.HasOverflowed());
+}
+
+u32 Random(u32* seed)
+{
+	*seed = *seed * 1103515245 + 12345;
+	return *seed >> 8;
+}
+
+// Fills the registers the generators read with garbage, keeping the counts
+// within what the hardware supports.
+void SetRandomState(u32 seed)
+{
+	for (size_t i = 0; i < sizeof(bpmem) / 4; ++i)
+		((u32*)&bpmem)[i] = Random(&seed);
+	for (size_t i = 0; i < sizeof(xfmem) / 4; ++i)
+		((u32*)&xfmem)[i] = Random(&seed);
+
+	bpmem.genMode.numtexgens = Random(&seed) % 9;
+	bpmem.genMode.numcolchans = Random(&seed) % 3;
+	bpmem.genMode.numindstages = Random(&seed) % 5;
+	xfmem.numTexGen.numTexGens = bpmem.genMode.numtexgens;
+	xfmem.numChan.numColorChans = bpmem.genMode.numcolchans;
+}
+}
+
+TEST(ShaderCode, FormatsLikeSnprintf)
+{
+	ExpectSameAsSnprintf("no format");
+	ExpectSameAsSnprintf("");
+	ExpectSameAsSnprintf("%d %i %u", 0, -1, 4000000000u);
+	ExpectSameAsSnprintf("%d %d", INT_MAX, INT_MIN);
+	ExpectSameAsSnprintf("c%d[%d].%s = %s;\n", 3, 12, "rgb", "tevin_a");
+	ExpectSameAsSnprintf("%c%c 100%%", 'x', 'y');
+	ExpectSameAsSnprintf("%d %f %s", 7, 1.5f, "after the fallback");
+	ExpectSameAsSnprintf("%03d|%-4s|%x", 5, "ab", 0xBEEF);
+}
+
+TEST(ShaderCode, StopsAtTheEndOfTheBuffer)
+{
+	char buffer[16];
+	memset(buffer, 0x7C, sizeof(buffer));
+	ShaderCode code;
+	code.SetBuffer(buffer, 8);
+	code.Write("%s", "0123");
+	code.Write("%d", 456);
+	EXPECT_FALSE(code.HasOverflowed());
+	code.Write("7%s", "89");
+	EXPECT_TRUE(code.HasOverflowed());
+	EXPECT_STREQ("0123456", code.GetBuffer());
+	EXPECT_EQ(0x7C, buffer[8]);
+
+	code.SetBuffer(buffer, 8);
+	code.Write("%f", 123456.0);
+	EXPECT_TRUE(code.HasOverflowed());
+	EXPECT_EQ(0x7C, buffer[8]);
+}
+
+TEST(ShaderUid, HashFollowsData)
+{
+	const u32 components = 0xFFFFFFFF;
+	PixelShaderUid uids[3];
+	for (int i = 0; i < 3; ++i)
+	{
+		SetRandomState(i == 2 ? 1 : 2);
+		GetPixelShaderUid(uids[i], DSTALPHA_NONE, API_OPENGL, components);
+	}
+	EXPECT_TRUE(uids[0] == uids[1]);
+	EXPECT_EQ(uids[0].GetHash(), uids[1].GetHash());
+	EXPECT_TRUE(uids[0] != uids[2]);
+
+	// A uid read from disk only has its data
+	PixelShaderUid loaded;
+	memcpy(&loaded.GetUidData<pixel_shader_uid_data>(), &uids[2].GetUidData(), sizeof(pixel_shader_uid_data));
+	EXPECT_TRUE(loaded != uids[2]);
+	loaded.CalculateHash();
+	EXPECT_TRUE(loaded == uids[2]);
+}
+
+// There is no dump of UIDs from real games, so the states are random ones.
+TEST(ShaderCode, RandomStatesFitBuffer)
+{
+	const u32 components = 0xFFFFFFFF;
+	for (int i = 0; i < 256; ++i)
+	{
+		SetRandomState(i);
+
+		PixelShaderCode pcode;
+		GeneratePixelShaderCode(pcode, DSTALPHA_DUAL_SOURCE_BLEND, API_OPENGL, components);
+		ASSERT_FALSE(pcode.HasOverflowed());
+
+		VertexShaderCode vcode;
+		GenerateVertexShaderCode(vcode, components, API_OPENGL);
+		ASSERT_FALSE(vcode.HasOverflowed());
+	}
+}
+
+// Not a correctness test: reports how fast shaders are generated, for the
+// same random states as above.
+// Run it with --gtest_also_run_disabled_tests.
+TEST(ShaderCode, DISABLED_Benchmark)
+{
+	const int num_states = 256;
+	const u32 components = 0xFFFFFFFF;
+	size_t bytes = 0;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < num_states; ++i)
+	{
+		SetRandomState(i);
+
+		PixelShaderCode pcode;
+		GeneratePixelShaderCode(pcode, DSTALPHA_DUAL_SOURCE_BLEND, API_OPENGL, components);
+		bytes += strlen(pcode.GetBuffer());
+
+		VertexShaderCode vcode;
+		GenerateVertexShaderCode(vcode, components, API_OPENGL);
+		bytes += strlen(vcode.GetBuffer());
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+
+	double seconds = std::chrono::duration<double>(end - start).count();
+	printf("%d pixel + vertex shaders in %.1f ms (%.1f MB/s)\n",
+		num_states, seconds * 1000.0, bytes / seconds / 1000000.0);
+}
@@ -0,0 +1,155 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "Common/Common.h"
+#include "Common/CPUDetect.h"
+#include "VideoCommon/TextureDecoder.h"
+
+#include <gtest/gtest.h>  // NOLINT
+
+// The test parameter type, outside the anonymous namespace so that the gtest
+// classes built around it don't get internal linkage.
+struct DecoderCase
+{
+	int format;
+	int tlutfmt;
+	const char* name;
+};
+
+namespace
+{
+const DecoderCase s_cases[] = {
+	{ GX_TF_I4, 0, "I4" },
+	{ GX_TF_I8, 0, "I8" },
+	{ GX_TF_IA4, 0, "IA4" },
+	{ GX_TF_IA8, 0, "IA8" },
+	{ GX_TF_RGB565, 0, "RGB565" },
+	{ GX_TF_RGB5A3, 0, "RGB5A3" },
+	{ GX_TF_RGBA8, 0, "RGBA8" },
+	{ GX_TF_CMPR, 0, "CMPR" },
+	{ GX_TF_C4, 0, "C4/IA8" },
+	{ GX_TF_C4, 1, "C4/RGB565" },
+	{ GX_TF_C4, 2, "C4/RGB5A3" },
+	{ GX_TF_C8, 0, "C8/IA8" },
+	{ GX_TF_C8, 1, "C8/RGB565" },
+	{ GX_TF_C8, 2, "C8/RGB5A3" },
+	{ GX_TF_C14X2, 0, "C14X2/IA8" },
+	{ GX_TF_C14X2, 1, "C14X2/RGB565" },
+	{ GX_TF_C14X2, 2, "C14X2/RGB5A3" },
+};
+
+const int TLUT_ADDRESS = 0x80000;
+
+void FillRandom(u8* data, size_t size, u32 seed)
+{
+	for (size_t i = 0; i < size; ++i)
+	{
+		seed = seed * 1103515245 + 12345;
+		data[i] = (u8)(seed >> 16);
+	}
+}
+}
+
+class TextureDecoderTest : public testing::TestWithParam<DecoderCase>
+{
+protected:
+	virtual void SetUp() override
+	{
+		m_had_avx2 = cpu_info.bAVX2;
+		FillRandom(&texMem[TLUT_ADDRESS], 16384 * 2, 1);
+	}
+
+	virtual void TearDown() override
+	{
+		cpu_info.bAVX2 = m_had_avx2;
+	}
+
+	std::vector<u8> MakeSource(int width, int height, u32 seed)
+	{
+		std::vector<u8> src(TexDecoder_GetTextureSizeInBytes(width, height, GetParam().format));
+		FillRandom(src.data(), src.size(), seed);
+		return src;
+	}
+
+	// Decodes to RGBA, with or without AVX2.
+	void Decode(std::vector<u32>* dst, const std::vector<u8>& src, int width, int height, bool avx2)
+	{
+		const DecoderCase& c = GetParam();
+		dst->resize(width * height);
+		cpu_info.bAVX2 = avx2;
+		TexDecoder_Decode((u8*)dst->data(), src.data(), width, height, c.format, TLUT_ADDRESS, c.tlutfmt, true);
+	}
+
+	bool m_had_avx2;
+};
+
+TEST_P(TextureDecoderTest, AVX2MatchesDefault)
+{
+	if (!m_had_avx2)
+	{
+		printf("AVX2 isn't supported, skipping.\n");
+		return;
+	}
+
+	const DecoderCase& c = GetParam();
+	const int block_width = TexDecoder_GetBlockWidthInTexels(c.format);
+	const int block_height = TexDecoder_GetBlockHeightInTexels(c.format);
+
+	// An odd number of blocks per row checks the decoding of a lone last block.
+	const int sizes[][2] = { { 64, 64 }, { block_width * 5, block_height * 3 }, { 8, 8 } };
+	for (const auto& size : sizes)
+	{
+		const int width = std::max(size[0], block_width);
+		const int height = std::max(size[1], block_height);
+		std::vector<u8> src = MakeSource(width, height, width * height);
+		std::vector<u32> expected, actual;
+		Decode(&expected, src, width, height, false);
+		Decode(&actual, src, width, height, true);
+		for (int i = 0; i < width * height; ++i)
+		{
+			ASSERT_EQ(expected[i], actual[i]) << c.name << " " << width << "x" << height
+				<< ": texel (" << i % width << ", " << i / width << ")";
+		}
+	}
+}
+
+// Not a correctness test: reports the throughput of both paths.
+// Run it with --gtest_also_run_disabled_tests.
+TEST_P(TextureDecoderTest, DISABLED_Benchmark)
+{
+	const DecoderCase& c = GetParam();
+	const int width = 512, height = 512, iterations = 20;
+	const bool paths[] = { false, true };
+	double mtexels[2] = {};
+	std::vector<u8> src = MakeSource(width, height, 1);
+	std::vector<u32> dst;
+
+	for (int p = 0; p < 2; ++p)
+	{
+		if (paths[p] && !m_had_avx2)
+			continue;
+
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < iterations; ++i)
+			Decode(&dst, src, width, height, paths[p]);
+		auto end = std::chrono::high_resolution_clock::now();
+
+		double seconds = std::chrono::duration<double>(end - start).count();
+		mtexels[p] = (double)width * height * iterations / seconds / 1000000.0;
+	}
+
+	printf("%-14s default: %8.1f MTexel/s  AVX2: %8.1f MTexel/s\n", c.name, mtexels[0], mtexels[1]);
+}
+
+// The generator function this defines has no declaration of its own: keep it
+// file-local.
+namespace
+{
+INSTANTIATE_TEST_CASE_P(AllFormats, TextureDecoderTest, testing::ValuesIn(s_cases));
+}
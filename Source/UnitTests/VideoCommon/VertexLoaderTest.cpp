@@ -3,6 +3,7 @@
 #include "Common/Common.h"
 #include "VideoCommon/DataReader.h"
 #include "VideoCommon/VertexLoader.h"
+#include "VideoCommon/VideoConfig.h"
 
 // Needs to be included later because it defines a TEST macro that conflicts
 // with a TEST method definition in x64Emitter.h.
@@ -151,6 +152,149 @@ TEST_F(VertexLoaderTest, PositionDirectU16XY)
 	ExpectOut(21.0f); ExpectOut(12.0f); ExpectOut(0.0f);
 }
 
+TEST_F(VertexLoaderTest, PositionIndexed)
+{
+	m_vtx_desc.Position = 3;        // Index16
+	m_vtx_attr.g0.PosElements = 1;  // XYZ
+	m_vtx_attr.g0.PosFormat = 3;    // S16
+	m_vtx_attr.g0.PosFrac = 2;
+
+	// Every other entry of the array is skipped.
+	const s16 positions[] = { 4, -8, 12, 0, 0, 0, -4, 400, 2, 0, 0, 0 };
+	u8 array[sizeof(positions)];
+	for (size_t i = 0; i < ArraySize(positions); i++)
+		*(u16*)&array[i * 2] = Common::swap16(positions[i]);
+	cached_arraybases[ARRAY_POSITION] = array;
+	arraystrides[ARRAY_POSITION] = 12;
+
+	VertexLoader loader(m_vtx_desc, m_vtx_attr);
+	ASSERT_EQ(2, loader.GetVertexSize());
+
+	Input<u16>(1); Input<u16>(0);
+	loader.RunVertices(m_vtx_attr, 7, 2);
+	ExpectOut(-1.0f); ExpectOut(100.0f); ExpectOut(0.5f);
+	ExpectOut(1.0f); ExpectOut(-2.0f); ExpectOut(3.0f);
+}
+
+TEST_F(VertexLoaderTest, NormalIndices3)
+{
+	m_vtx_desc.Position = 1;           // Direct
+	m_vtx_attr.g0.PosFormat = 0;       // U8
+	m_vtx_desc.Normal = 2;             // Index8
+	m_vtx_attr.g0.NormalElements = 1;  // NBT
+	m_vtx_attr.g0.NormalFormat = 1;    // S8
+	m_vtx_attr.g0.NormalIndex3 = 1;
+
+	const s8 normals[] = { 64, 0, -64, 32, 16, 8, -32, -16, -8 };
+	cached_arraybases[ARRAY_NORMAL] = (u8*)normals;
+	arraystrides[ARRAY_NORMAL] = 1;
+
+	VertexLoader loader(m_vtx_desc, m_vtx_attr);
+	ASSERT_EQ(2 + 3, loader.GetVertexSize());
+
+	// Each of the normal, binormal and tangent comes from its own index, and
+	// at its own offset.
+	Input<u8>(5); Input<u8>(6); Input<u8>(0); Input<u8>(1); Input<u8>(0);
+	loader.RunVertices(m_vtx_attr, 7, 1);
+	ExpectOut(5.0f); ExpectOut(6.0f); ExpectOut(0.0f);
+	ExpectOut(1.0f); ExpectOut(0.0f); ExpectOut(-1.0f);
+	ExpectOut(0.25f); ExpectOut(0.125f); ExpectOut(-0.5f);
+	ExpectOut(-0.5f); ExpectOut(-0.25f); ExpectOut(-0.125f);
+}
+
+TEST_F(VertexLoaderTest, ColorFormats)
+{
+	struct ColorCase
+	{
+		int format;
+		u32 input;
+		int size;
+		u32 expected;
+	};
+	const ColorCase cases[] = {
+		{ FORMAT_16B_565, 0xF81F0000, 2, 0xFFFF00FF },
+		{ FORMAT_16B_565, 0x07E00000, 2, 0xFF00FF00 },
+		{ FORMAT_24B_888, 0x12345600, 3, 0xFF563412 },
+		{ FORMAT_32B_888x, 0x12345678, 4, 0xFF563412 },
+		{ FORMAT_16B_4444, 0x12340000, 2, 0x44332211 },
+		{ FORMAT_24B_6666, 0xFC0FC000, 3, 0x00FF00FF },
+		{ FORMAT_32B_8888, 0x12345678, 4, 0x78563412 },
+	};
+
+	for (const ColorCase& c : cases)
+	{
+		SetUp();
+		m_vtx_desc.Position = 1;        // Direct
+		m_vtx_attr.g0.PosFormat = 0;    // U8
+		m_vtx_desc.Color0 = 1;          // Direct
+		m_vtx_attr.g0.Color0Comp = c.format;
+		m_vtx_attr.g0.Color0Elements = 1;  // Has alpha
+
+		VertexLoader loader(m_vtx_desc, m_vtx_attr);
+		ASSERT_EQ(2 + c.size, loader.GetVertexSize());
+
+		Input<u8>(0); Input<u8>(0); Input(c.input);
+		loader.RunVertices(m_vtx_attr, 7, 1);
+		Output<float>(); Output<float>(); Output<float>();
+		EXPECT_EQ(c.expected, Output<u32>()) << "format " << c.format;
+	}
+}
+
+TEST_F(VertexLoaderTest, MatrixIndices)
+{
+	m_vtx_desc.PosMatIdx = 1;
+	m_vtx_desc.Tex0MatIdx = 1;
+	m_vtx_desc.Tex1MatIdx = 1;
+	m_vtx_desc.Position = 1;              // Direct
+	m_vtx_attr.g0.PosFormat = 0;          // U8
+	m_vtx_desc.Tex0Coord = 1;             // Direct
+	m_vtx_attr.g0.Tex0CoordElements = 0;  // S
+	m_vtx_attr.g0.Tex0CoordFormat = 1;    // S8
+	m_vtx_attr.g0.Tex0Frac = 1;
+
+	VertexLoader loader(m_vtx_desc, m_vtx_attr);
+	ASSERT_EQ(3 + 2 + 1, loader.GetVertexSize());
+	ASSERT_EQ((3 + 3 + 4 + 1) * 4, loader.GetNativeVertexDeclaration().stride);
+
+	// Only the low 6 bits of the indices are used.
+	Input<u8>(0x41); Input<u8>(7); Input<u8>(9);
+	Input<u8>(1); Input<u8>(2); Input<s8>(-3);
+	loader.RunVertices(m_vtx_attr, 7, 1);
+	ExpectOut(1.0f); ExpectOut(2.0f); ExpectOut(0.0f);
+	// Texture coordinate 0 is padded to 3 components, coordinate 1 to 4.
+	ExpectOut(-1.5f); ExpectOut(0.0f); ExpectOut(7.0f);
+	ExpectOut(0.0f); ExpectOut(0.0f); ExpectOut(9.0f); ExpectOut(0.0f);
+	ExpectOut<u32>(1);
+}
+
+TEST_F(VertexLoaderTest, BoundingBox)
+{
+	// The position is converted through calls when the bounding box is used.
+	g_ActiveConfig.bUseBBox = true;
+	m_vtx_desc.PosMatIdx = 1;
+	m_vtx_desc.Position = 1;        // Direct
+	m_vtx_attr.g0.PosElements = 0;  // XY
+	m_vtx_attr.g0.PosFormat = 2;    // U16
+	m_vtx_desc.Color0 = 1;          // Direct
+	m_vtx_attr.g0.Color0Comp = 5;   // RGBA8888
+	m_vtx_attr.g0.Color0Elements = 1;
+
+	VertexLoader loader(m_vtx_desc, m_vtx_attr);
+	g_ActiveConfig.bUseBBox = false;
+
+	for (int i = 0; i < 2; i++)
+	{
+		Input<u8>(3 + i); Input<u16>(10); Input<u16>(20 + i); Input<u32>(0x11223344);
+	}
+	loader.RunVertices(m_vtx_attr, 7, 2);
+	for (int i = 0; i < 2; i++)
+	{
+		ExpectOut(10.0f); ExpectOut(20.0f + i); ExpectOut(0.0f);
+		ExpectOut<u32>(0x44332211);
+		ExpectOut<u32>(3 + i);
+	}
+}
+
 TEST_F(VertexLoaderTest, PositionDirectFloatXYZSpeed)
 {
 	m_vtx_desc.Position = 1;        // Direct
@@ -247,3 +391,38 @@ TEST_F(VertexLoaderTest, LargeFloatVertexSpeed)
 		loader.RunVertices(m_vtx_attr, 7, 100000);
 	}
 }
+
+TEST_F(VertexLoaderTest, IndexedVertexSpeed)
+{
+	// A typical model: indexed position, normal, color and texture coordinate.
+	m_vtx_desc.Position = 3;              // Index16
+	m_vtx_desc.Normal = 3;                // Index16
+	m_vtx_desc.Color0 = 3;                // Index16
+	m_vtx_desc.Tex0Coord = 3;             // Index16
+
+	m_vtx_attr.g0.PosElements = 1;        // XYZ
+	m_vtx_attr.g0.PosFormat = 3;          // S16
+	m_vtx_attr.g0.NormalElements = 0;     // N
+	m_vtx_attr.g0.NormalFormat = 1;       // S8
+	m_vtx_attr.g0.Color0Elements = 1;     // Has Alpha
+	m_vtx_attr.g0.Color0Comp = 5;         // RGBA8888
+	m_vtx_attr.g0.Tex0CoordElements = 1;  // ST
+	m_vtx_attr.g0.Tex0CoordFormat = 3;    // S16
+
+	for (int i = 0; i < 4; ++i)
+	{
+		cached_arraybases[ARRAY_POSITION + i] = &input_memory[8 * 1024 * 1024];
+		arraystrides[ARRAY_POSITION + i] = 6;
+	}
+	cached_arraybases[ARRAY_TEXCOORD0] = &input_memory[8 * 1024 * 1024];
+	arraystrides[ARRAY_TEXCOORD0] = 4;
+
+	VertexLoader loader(m_vtx_desc, m_vtx_attr);
+	ASSERT_EQ(4 * sizeof (u16), (u32)loader.GetVertexSize());
+
+	for (int i = 0; i < 1000; ++i)
+	{
+		ResetPointers();
+		loader.RunVertices(m_vtx_attr, 7, 100000);
+	}
+}